@@ -11,19 +11,38 @@ New-Item -ItemType Directory -Path "obj\ui" -Force | Out-Null
 
 $CXX = "g++"
 $CC = "gcc"
-$CXXFLAGS = "-std=c++17", "-Wall", "-Wextra", "-O2", "-g", "-Isrc", "-Isqlite/sqlite-amalgamation-3460100", "-DSQLITE_THREADSAFE=0"
-$CFLAGS = "-O2", "-g", "-DSQLITE_THREADSAFE=0", "-DSQLITE_OMIT_LOAD_EXTENSION"
-$LDFLAGS = "-static-libgcc", "-static-libstdc++"
+$CXXFLAGS = "-std=c++17", "-Wall", "-Wextra", "-O2", "-g", "-Isrc", "-Isqlite/sqlite-amalgamation-3460100", "-pthread"
+$CFLAGS = "-O2", "-g", "-DSQLITE_THREADSAFE=1", "-DSQLITE_OMIT_LOAD_EXTENSION"
+$LDFLAGS = "-static-libgcc", "-static-libstdc++", "-pthread"
 
 $sources = @(
     "src\main.cpp",
     "src\models\User.cpp",
     "src\models\Wallet.cpp", 
+    "src\models\Uuid.cpp",
     "src\security\OTPManager.cpp",
+    "src\security\OTPStore.cpp",
     "src\security\SecurityUtils.cpp",
+    "src\storage\InMemoryStorage.cpp",
     "src\storage\DatabaseManager.cpp",
+    "src\storage\GroupCommitWriter.cpp",
+    "src\storage\LedgerJournal.cpp",
+    "src\storage\TransferLedger.cpp",
+    "src\storage\TransactionExporter.cpp",
+    "src\storage\BackupJob.cpp",
+    "src\storage\FileChecksum.cpp",
+    "src\storage\FileCopy.cpp",
+    "src\storage\BackupCatalog.cpp",
+    "src\storage\WalArchiver.cpp",
+    "src\storage\IdColumns.cpp",
     "src\storage\OTPStorage.cpp",
+    "src\storage\PageStore.cpp",
+    "src\storage\ReaderPool.cpp",
+    "src\storage\StatementCache.cpp",
+    "src\storage\TransactionArchive.cpp",
     "src\system\AuthSystem.cpp",
+    "src\system\MaintenanceScheduler.cpp",
+    "src\system\BulkLoader.cpp",
     "src\system\WalletManager.cpp",
     "src\ui\UserInterface.cpp",
     "src\ui\UserValidator.cpp",
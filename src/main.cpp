@@ -1,11 +1,34 @@
 #include "system/AuthSystem.h"
 #include "ui/UserInterface.h"
+#include "storage/InMemoryStorage.h"
 #include <iostream>
 #include <locale>
+#include <memory>
+#include <cstring>
+
+int main(int argc, char* argv[]) {
+    // --in-memory: nothing is written to disk; for demos and load tests
+    // --ledger: transfers are journaled first and applied to SQLite behind
+    bool inMemory = false;
+    bool ledgerMode = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--in-memory") == 0) {
+            inMemory = true;
+        } else if (std::strcmp(argv[i], "--ledger") == 0) {
+            ledgerMode = true;
+        }
+    }
 
-int main() {
     try {
-        AuthSystem authSystem;
+        std::shared_ptr<StorageBackend> storage;
+        if (inMemory) {
+            storage = std::make_shared<InMemoryStorage>();
+        } else {
+            auto database = std::make_shared<DatabaseManager>();
+            database->setLedgerMode(ledgerMode);
+            storage = database;
+        }
+        AuthSystem authSystem(storage);
         UserInterface ui(authSystem);
         
         std::cout << "=================================================\n";
@@ -0,0 +1,49 @@
+#include "Uuid.h"
+#include <cstring>
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+// Offsets of the dashes in the 36-character canonical form
+static bool isDashPosition(size_t index) {
+    return index == 8 || index == 13 || index == 18 || index == 23;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+Uuid::Uuid(const uint8_t* data) {
+    std::memcpy(bytes.data(), data, SIZE);
+}
+
+bool Uuid::parse(const std::string& text, Uuid& out) {
+    if (text.size() != 36) return false;
+
+    size_t byteIndex = 0;
+    for (size_t i = 0; i < text.size(); ) {
+        if (isDashPosition(i)) {
+            if (text[i] != '-') return false;
+            ++i;
+            continue;
+        }
+        int high = hexValue(text[i]);
+        int low = hexValue(text[i + 1]);
+        if (high < 0 || low < 0 || isDashPosition(i + 1)) return false;
+        out.bytes[byteIndex++] = static_cast<uint8_t>((high << 4) | low);
+        i += 2;
+    }
+    return byteIndex == SIZE;
+}
+
+std::string Uuid::toString() const {
+    std::string text;
+    text.reserve(36);
+    for (size_t i = 0; i < SIZE; ++i) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) text += '-';
+        text += HEX_DIGITS[bytes[i] >> 4];
+        text += HEX_DIGITS[bytes[i] & 0x0F];
+    }
+    return text;
+}
@@ -0,0 +1,31 @@
+#ifndef UUID_H
+#define UUID_H
+
+#include <array>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Fixed-size binary form of the canonical lowercase UUID strings produced by
+// SecurityUtils::generateUUID. Only strings that round-trip exactly through
+// toString() are accepted, so converting never changes an ID's identity.
+struct Uuid {
+    static const size_t SIZE = 16;
+
+    std::array<uint8_t, SIZE> bytes{};
+
+    Uuid() = default;
+    explicit Uuid(const uint8_t* data);
+
+    // Parses "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" (lowercase hex only)
+    static bool parse(const std::string& text, Uuid& out);
+
+    std::string toString() const;
+    const uint8_t* data() const { return bytes.data(); }
+
+    bool operator==(const Uuid& other) const { return bytes == other.bytes; }
+    bool operator!=(const Uuid& other) const { return bytes != other.bytes; }
+    bool operator<(const Uuid& other) const { return bytes < other.bytes; }
+};
+
+#endif
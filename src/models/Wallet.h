@@ -5,6 +5,8 @@
 #include <vector>
 #include <chrono>
 #include <memory>
+#include <cstdint>
+#include <limits>
 
 enum class TransactionType {
     TRANSFER_IN,
@@ -53,6 +55,44 @@ struct Transaction {
     static Transaction fromJson(const std::string& json);
 };
 
+struct TransferRequest {
+    std::string fromWalletId;
+    std::string toWalletId;
+    double amount;
+    std::string description;
+    std::string otpCode;
+};
+
+struct TransferResult {
+    bool success;
+    std::string message;
+    std::string transactionId;
+    double newBalance;
+};
+
+// Keyset position in a wallet's history (newest first). The default cursor
+// points before the newest transaction, i.e. it starts at page one.
+struct HistoryCursor {
+    int64_t timestamp = std::numeric_limits<int64_t>::max(); // seconds since epoch
+    std::string transactionId;
+
+    bool isStart() const { return timestamp == std::numeric_limits<int64_t>::max(); }
+};
+
+struct TransactionPage {
+    std::vector<Transaction> transactions;
+    HistoryCursor nextCursor;  // pass back to fetch the following page
+    bool hasMore = false;
+};
+
+// Money moved in and out of one wallet over its whole history
+struct WalletFlowSummary {
+    double totalIn = 0.0;
+    double totalOut = 0.0;
+    int countIn = 0;
+    int countOut = 0;
+};
+
 class Wallet {
 protected:
     std::string walletId;
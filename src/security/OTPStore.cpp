@@ -0,0 +1,166 @@
+#include "OTPStore.h"
+#include "../storage/OTPStorage.h"
+#include <functional>
+#include <algorithm>
+
+OTPStore::OTPStore(bool writeThrough)
+    : epoch(Clock::now()), writeThrough(writeThrough) {
+}
+
+std::string OTPStore::makeKey(const std::string& userId, const std::string& purpose) {
+    std::string key;
+    key.reserve(userId.size() + purpose.size() + 1);
+    key += userId;
+    key += '\x1f';
+    key += purpose;
+    return key;
+}
+
+OTPStore::Shard& OTPStore::shardFor(const std::string& key) {
+    return shards[std::hash<std::string>()(key) % SHARD_COUNT];
+}
+
+uint64_t OTPStore::tickOf(Clock::time_point time) const {
+    if (time <= epoch) return 0;
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(time - epoch).count());
+}
+
+bool OTPStore::put(const std::string& userId, const std::string& purpose,
+                   const std::string& code, std::chrono::seconds ttl) {
+    std::string key = makeKey(userId, purpose);
+    Clock::time_point now = Clock::now();
+    Clock::time_point expiresAt = now + ttl;
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        advance(shard, tickOf(now));
+
+        uint64_t generation = shard.nextGeneration++;
+        shard.entries[key] = Entry{code, expiresAt, generation};
+        // Fire on the first tick at or after the expiry time
+        schedule(shard, TimerRecord{key, generation, tickOf(expiresAt) + 1});
+    }
+
+    if (writeThrough) {
+        return OTPStorage::saveOTP(userId, purpose, code, static_cast<int>(ttl.count()));
+    }
+    return true;
+}
+
+bool OTPStore::consume(const std::string& userId, const std::string& purpose,
+                       const std::string& code) {
+    std::string key = makeKey(userId, purpose);
+    Clock::time_point now = Clock::now();
+    bool found = false;
+    bool matched = false;
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        advance(shard, tickOf(now));
+
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end() && now < it->second.expiresAt) {
+            found = true;
+            if (it->second.code == code) {
+                matched = true;
+                // The wheel record is left behind; its generation no longer matches
+                shard.entries.erase(it);
+            }
+        }
+    }
+
+    if (!writeThrough) {
+        return matched;
+    }
+    if (matched) {
+        OTPStorage::removeOTP(userId, purpose);
+        return true;
+    }
+    // Only codes issued before this process started live solely on disk
+    return !found && OTPStorage::consumeOTP(userId, purpose, code);
+}
+
+void OTPStore::remove(const std::string& userId, const std::string& purpose) {
+    std::string key = makeKey(userId, purpose);
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.erase(key);
+    }
+
+    if (writeThrough) {
+        OTPStorage::removeOTP(userId, purpose);
+    }
+}
+
+size_t OTPStore::expire() {
+    uint64_t nowTick = tickOf(Clock::now());
+    size_t removed = 0;
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        removed += advance(shard, nowTick);
+    }
+
+    if (writeThrough) {
+        OTPStorage::cleanupExpiredOTP();
+    }
+    return removed;
+}
+
+size_t OTPStore::size() const {
+    size_t total = 0;
+    for (const Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.entries.size();
+    }
+    return total;
+}
+
+void OTPStore::schedule(Shard& shard, TimerRecord record) {
+    // Slots up to currentTick have already fired
+    uint64_t fireTick = std::max(record.expireTick, shard.currentTick + 1);
+
+    if (fireTick - shard.currentTick < WHEEL_SLOTS) {
+        shard.seconds[fireTick % WHEEL_SLOTS].push_back(std::move(record));
+    } else {
+        // Beyond the level-1 horizon the record parks in the furthest slot
+        // and is rescheduled each time that slot cascades
+        uint64_t horizon = shard.currentTick / WHEEL_SLOTS + WHEEL_SLOTS - 1;
+        uint64_t minute = std::min<uint64_t>(record.expireTick / WHEEL_SLOTS, horizon);
+        shard.minutes[minute % WHEEL_SLOTS].push_back(std::move(record));
+    }
+}
+
+size_t OTPStore::advance(Shard& shard, uint64_t nowTick) {
+    size_t removed = 0;
+
+    while (shard.currentTick < nowTick) {
+        ++shard.currentTick;
+
+        // Entering a new level-1 slot: spread its records over level 0
+        if (shard.currentTick % WHEEL_SLOTS == 0) {
+            std::vector<TimerRecord> cascade;
+            cascade.swap(shard.minutes[(shard.currentTick / WHEEL_SLOTS) % WHEEL_SLOTS]);
+            for (auto& record : cascade) {
+                schedule(shard, std::move(record));
+            }
+        }
+
+        std::vector<TimerRecord> due;
+        due.swap(shard.seconds[shard.currentTick % WHEEL_SLOTS]);
+        for (auto& record : due) {
+            if (record.expireTick > shard.currentTick) {
+                schedule(shard, std::move(record));
+                continue;
+            }
+            auto it = shard.entries.find(record.key);
+            if (it != shard.entries.end() && it->second.generation == record.generation) {
+                shard.entries.erase(it);
+                ++removed;
+            }
+        }
+    }
+
+    return removed;
+}
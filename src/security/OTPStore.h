@@ -0,0 +1,89 @@
+#ifndef OTP_STORE_H
+#define OTP_STORE_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef _WIN32
+    #include "../thread_compat.h"
+#else
+    #include <mutex>
+#endif
+
+// In-memory OTP codes keyed by (userId, purpose).
+// Keys are spread over SHARD_COUNT independently locked shards. Each shard
+// expires its codes with a two-level timing wheel (1 s slots, then 64 s
+// slots), so expiry costs O(expired codes) instead of a table scan.
+// With write-through enabled every change is mirrored to OTPStorage, and
+// codes missing from memory (e.g. after a restart) are checked there.
+class OTPStore {
+public:
+    static const size_t SHARD_COUNT = 16;
+    static const size_t WHEEL_SLOTS = 64;
+
+    explicit OTPStore(bool writeThrough = false);
+
+    OTPStore(const OTPStore&) = delete;
+    OTPStore& operator=(const OTPStore&) = delete;
+
+    // Stores a code, replacing any previous one for the same user and purpose
+    bool put(const std::string& userId, const std::string& purpose,
+             const std::string& code, std::chrono::seconds ttl);
+
+    // Removes the code and returns true only if it matches and is unexpired
+    bool consume(const std::string& userId, const std::string& purpose,
+                 const std::string& code);
+
+    void remove(const std::string& userId, const std::string& purpose);
+
+    // Advances every shard's wheel to now; returns the number of codes dropped
+    size_t expire();
+
+    size_t size() const;
+    void setWriteThrough(bool enabled) { writeThrough = enabled; }
+    bool isWriteThrough() const { return writeThrough; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        std::string code;
+        Clock::time_point expiresAt;
+        uint64_t generation;   // identifies this put among wheel records
+    };
+
+    struct TimerRecord {
+        std::string key;
+        uint64_t generation;
+        uint64_t expireTick;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+        std::array<std::vector<TimerRecord>, WHEEL_SLOTS> seconds;   // level 0
+        std::array<std::vector<TimerRecord>, WHEEL_SLOTS> minutes;   // level 1
+        uint64_t currentTick = 0;
+        uint64_t nextGeneration = 0;
+    };
+
+    std::array<Shard, SHARD_COUNT> shards;
+    Clock::time_point epoch;
+    std::atomic<bool> writeThrough;
+
+    static std::string makeKey(const std::string& userId, const std::string& purpose);
+    Shard& shardFor(const std::string& key);
+    uint64_t tickOf(Clock::time_point time) const;
+
+    // All of the following require the shard's mutex
+    void schedule(Shard& shard, TimerRecord record);
+    size_t advance(Shard& shard, uint64_t nowTick);
+};
+
+#endif
@@ -3,13 +3,12 @@
 #include <iomanip>
 #include <algorithm>
 #include "picosha2.h"
-#include "../storage/OTPStorage.h"
 #include <functional>  // For std::hash
 // Removed OpenSSL includes for simple compilation
 
 // Initialize static members
 std::mt19937 SecurityUtils::rng;
-// std::unordered_map<std::string, std::pair<std::string, std::chrono::system_clock::time_point>> SecurityUtils::otpStore;
+OTPStore SecurityUtils::otpStore;
 const int SecurityUtils::OTP_VALIDITY_MINUTES;
 
 void SecurityUtils::initialize() {
@@ -71,21 +70,23 @@ std::string SecurityUtils::generatePassword(int length, bool includeSpecialChars
 std::string SecurityUtils::generateOTP(const std::string& userId, const std::string& purpose) {
     std::uniform_int_distribution<> dist(100000, 999999);
     std::string otp = std::to_string(dist(rng));
-    OTPStorage::saveOTP(userId, purpose, otp, OTP_VALIDITY_MINUTES * 60);
+    otpStore.put(userId, purpose, otp, std::chrono::minutes(OTP_VALIDITY_MINUTES));
     return otp;
 }
 
 bool SecurityUtils::verifyOTP(const std::string& userId, const std::string& otpCode, const std::string& purpose) {
-    std::string correctOTP = OTPStorage::getOTP(userId, purpose);
-    if (!correctOTP.empty() && correctOTP == otpCode) {
-        OTPStorage::removeOTP(userId, purpose);
-        return true;
+    if (otpCode.empty()) {
+        return false;
     }
-    return false;
+    return otpStore.consume(userId, purpose, otpCode);
 }
 
 void SecurityUtils::cleanupExpiredOTP() {
-    OTPStorage::cleanupExpiredOTP();
+    otpStore.expire();
+}
+
+void SecurityUtils::setOTPWriteThrough(bool enabled) {
+    otpStore.setWriteThrough(enabled);
 }
 
 std::string SecurityUtils::generateUUID() {
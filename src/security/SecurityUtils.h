@@ -4,10 +4,11 @@
 #include <random>
 #include <chrono>
 #include <unordered_map>
+#include "OTPStore.h"
 class SecurityUtils {
 private:
     static std::mt19937 rng;
-    static std::unordered_map<std::string, std::pair<std::string, std::chrono::system_clock::time_point>> otpStore;
+    static OTPStore otpStore;
     static const int OTP_VALIDITY_MINUTES = 5;
     static const int OTP_LENGTH = 6;
 
@@ -33,6 +34,8 @@ public:
     static std::string encrypt(const std::string& data, const std::string& key);
     static std::string decrypt(const std::string& encryptedData, const std::string& key);
     static void cleanupExpiredOTP();
+    // Mirror OTPs to the database so they survive a restart (off by default)
+    static void setOTPWriteThrough(bool enabled);
     static std::string sha256(const std::string& input);
 
 private:
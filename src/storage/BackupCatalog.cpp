@@ -0,0 +1,208 @@
+#include "BackupCatalog.h"
+#include "FileCopy.h"
+#include "../security/SecurityUtils.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <ctime>
+
+const char* BackupCatalog::MANIFEST_NAME = "backup_manifest.tsv";
+
+BackupCatalog::BackupCatalog(const std::string& directory)
+    : directory(directory),
+      manifestPath(directory + "/" + MANIFEST_NAME),
+      loaded(false) {
+}
+
+// Tabs, newlines and backslashes in free text are escaped so each entry
+// stays on one line with a fixed number of fields
+static std::string escapeField(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+static std::string unescapeField(const std::string& value) {
+    std::string plain;
+    plain.reserve(value.size());
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] != '\\' || i + 1 == value.size()) {
+            plain += value[i];
+            continue;
+        }
+        char next = value[++i];
+        plain += next == 't' ? '\t' : next == 'n' ? '\n' : next == 'r' ? '\r' : next;
+    }
+    return plain;
+}
+
+std::string BackupCatalog::formatEntry(const BackupInfo& info) {
+    std::ostringstream line;
+    line << info.backupId << '\t'
+         << escapeField(info.filename) << '\t'
+         << static_cast<int>(info.type) << '\t'
+         << std::chrono::duration_cast<std::chrono::seconds>(info.timestamp.time_since_epoch()).count() << '\t'
+         << info.fileSize << '\t'
+         << info.checksum << '\t'
+         << escapeField(info.description);
+    return line.str();
+}
+
+bool BackupCatalog::parseEntry(const std::string& line, BackupInfo& info) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+        if (tab == std::string::npos) break;
+        start = tab + 1;
+    }
+    if (fields.size() != 7 || fields[0].empty()) return false;
+
+    try {
+        info.backupId = fields[0];
+        info.filename = unescapeField(fields[1]);
+        info.type = static_cast<BackupType>(std::stoi(fields[2]));
+        info.timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(std::stoll(fields[3])));
+        info.fileSize = static_cast<size_t>(std::stoull(fields[4]));
+        info.checksum = fields[5];
+        info.description = unescapeField(fields[6]);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+void BackupCatalog::ensureLoaded() {
+    if (loaded) return;
+    loaded = true;
+
+    if (!loadManifest()) {
+        importLegacyBackups();
+        writeManifest();
+    }
+}
+
+bool BackupCatalog::loadManifest() {
+    std::ifstream manifest(manifestPath);
+    if (!manifest) return false;
+
+    std::string line;
+    while (std::getline(manifest, line)) {
+        if (line.empty()) continue;
+        BackupInfo info;
+        if (parseEntry(line, info)) {
+            entries.push_back(info);
+        } else {
+            std::cerr << "Skipping malformed backup manifest entry" << std::endl;
+        }
+    }
+    return true;
+}
+
+void BackupCatalog::importLegacyBackups() {
+    std::error_code ec;
+    std::filesystem::directory_iterator it(directory, ec);
+    if (ec) return;
+
+    for (const auto& entry : it) {
+        std::string name = entry.path().filename().string();
+        // backup_YYYYmmdd_HHMMSS.db, as written by DatabaseManager::startBackup
+        if (name.size() != 25 || name.compare(0, 7, "backup_") != 0 ||
+            name.compare(name.size() - 3, 3, ".db") != 0) {
+            continue;
+        }
+
+        std::tm created = {};
+        std::istringstream stamp(name.substr(7, 15));
+        stamp >> std::get_time(&created, "%Y%m%d_%H%M%S");
+        if (stamp.fail()) continue;
+        created.tm_isdst = -1;
+
+        BackupInfo info;
+        info.backupId = SecurityUtils::generateUUID();
+        info.filename = directory + "/" + name;
+        info.type = BackupType::MANUAL;
+        info.timestamp = std::chrono::system_clock::from_time_t(std::mktime(&created));
+        info.fileSize = static_cast<size_t>(entry.file_size(ec));
+        info.description = "Imported backup";
+        entries.push_back(info);
+    }
+
+    std::sort(entries.begin(), entries.end(),
+        [](const BackupInfo& a, const BackupInfo& b) {
+            return a.timestamp < b.timestamp;
+        });
+}
+
+bool BackupCatalog::writeManifest() const {
+    std::string tempPath = manifestPath + ".tmp";
+    {
+        std::ofstream manifest(tempPath, std::ios::trunc);
+        if (!manifest) return false;
+        for (const auto& info : entries) {
+            manifest << formatEntry(info) << '\n';
+        }
+        manifest.flush();
+        if (!manifest) return false;
+    }
+
+    return FileCopy::replace(tempPath, manifestPath);
+}
+
+const std::vector<BackupInfo>& BackupCatalog::getEntries() {
+    ensureLoaded();
+    return entries;
+}
+
+bool BackupCatalog::find(const std::string& backupId, BackupInfo& info) {
+    ensureLoaded();
+    auto it = std::find_if(entries.begin(), entries.end(),
+        [&backupId](const BackupInfo& entry) {
+            return entry.backupId == backupId;
+        });
+    if (it == entries.end()) return false;
+    info = *it;
+    return true;
+}
+
+bool BackupCatalog::add(const BackupInfo& info) {
+    ensureLoaded();
+
+    // Without a manifest, the first load imports every backup file on disk,
+    // including the one being added here; replace that imported entry
+    auto existing = std::find_if(entries.begin(), entries.end(),
+        [&info](const BackupInfo& entry) {
+            return entry.filename == info.filename;
+        });
+    if (existing != entries.end()) {
+        *existing = info;
+        return writeManifest();
+    }
+
+    entries.push_back(info);
+
+    std::ofstream manifest(manifestPath, std::ios::app);
+    if (!manifest) return false;
+    manifest << formatEntry(info) << '\n';
+    manifest.flush();
+    return static_cast<bool>(manifest);
+}
+
+bool BackupCatalog::replaceAll(const std::vector<BackupInfo>& newEntries) {
+    ensureLoaded();
+    entries = newEntries;
+    return writeManifest();
+}
@@ -0,0 +1,60 @@
+#ifndef BACKUP_CATALOG_H
+#define BACKUP_CATALOG_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+
+enum class BackupType {
+    MANUAL,
+    AUTO,
+    EMERGENCY
+};
+
+struct BackupInfo {
+    std::string backupId;
+    std::string filename;
+    BackupType type;
+    std::chrono::system_clock::time_point timestamp;
+    size_t fileSize;
+    std::string checksum;
+    std::string description;
+};
+
+// Persistent list of backups, kept as a tab-separated manifest next to the
+// backup files so it survives restarts and database restores.
+// The manifest is read on first use only; listing never opens backup files.
+// When no manifest exists yet, existing backup_*.db files are imported from
+// their names and sizes (without checksums) and a manifest is written.
+// Not thread-safe: the owner serializes access.
+class BackupCatalog {
+private:
+    std::string directory;
+    std::string manifestPath;
+    bool loaded;
+    std::vector<BackupInfo> entries;
+
+    void ensureLoaded();
+    bool loadManifest();
+    void importLegacyBackups();
+    bool writeManifest() const;
+
+    static std::string formatEntry(const BackupInfo& info);
+    static bool parseEntry(const std::string& line, BackupInfo& info);
+
+public:
+    static const char* MANIFEST_NAME;
+
+    explicit BackupCatalog(const std::string& directory);
+
+    const std::vector<BackupInfo>& getEntries();
+    bool find(const std::string& backupId, BackupInfo& info);
+
+    // Appends one entry to the manifest
+    bool add(const BackupInfo& info);
+    // Rewrites the manifest with exactly these entries (atomic rename)
+    bool replaceAll(const std::vector<BackupInfo>& newEntries);
+};
+
+#endif
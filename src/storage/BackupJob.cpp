@@ -0,0 +1,166 @@
+#include "BackupJob.h"
+#include <sqlite3.h>
+#include <cstdio>
+#include <iostream>
+
+BackupJob::BackupJob(const std::string& sourcePath, const std::string& targetPath,
+                     int pagesPerStep, std::chrono::milliseconds stepPause,
+                     FinishedCallback onFinished)
+    : sourcePath(sourcePath),
+      targetPath(targetPath),
+      pagesPerStep(pagesPerStep > 0 ? pagesPerStep : DEFAULT_PAGES_PER_STEP),
+      stepPause(stepPause),
+      onFinished(onFinished),
+      state(State::PENDING),
+      cancelRequested(false),
+      totalPages(0),
+      remainingPages(0) {
+}
+
+BackupJob::~BackupJob() {
+    cancel();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void BackupJob::start() {
+    State expected = State::PENDING;
+    if (state.compare_exchange_strong(expected, State::RUNNING)) {
+        worker = std::thread(&BackupJob::run, this);
+    }
+}
+
+void BackupJob::cancel() {
+    cancelRequested = true;
+}
+
+bool BackupJob::wait() {
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        finished.wait(lock, [this] { return state != State::PENDING && state != State::RUNNING; });
+    }
+    return state == State::COMPLETED;
+}
+
+bool BackupJob::isFinished() const {
+    State current = state.load();
+    return current != State::PENDING && current != State::RUNNING;
+}
+
+double BackupJob::getProgress() const {
+    if (state == State::COMPLETED) return 1.0;
+    int total = totalPages.load();
+    if (total <= 0) return 0.0;
+    return static_cast<double>(total - remainingPages.load()) / total;
+}
+
+void BackupJob::run() {
+    std::string partialPath = targetPath + ".part";
+    std::remove(partialPath.c_str());
+
+    State result = copy();
+
+    if (result == State::COMPLETED) {
+        std::remove(targetPath.c_str());
+        if (std::rename(partialPath.c_str(), targetPath.c_str()) != 0) {
+            errorMessage = "Cannot move backup into place: " + targetPath;
+            result = State::FAILED;
+        }
+    }
+    if (result != State::COMPLETED) {
+        std::remove(partialPath.c_str());
+    }
+
+    finish(result);
+}
+
+BackupJob::State BackupJob::copy() {
+    std::string partialPath = targetPath + ".part";
+
+    sqlite3* source = nullptr;
+    if (sqlite3_open_v2(sourcePath.c_str(), &source,
+                        SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) != SQLITE_OK) {
+        errorMessage = std::string("Cannot open backup source: ") + sqlite3_errmsg(source);
+        sqlite3_close(source);
+        return State::FAILED;
+    }
+    sqlite3_busy_timeout(source, 5000);
+
+    // Pin one snapshot for the whole copy; backup_step reuses this read
+    // transaction instead of starting (and restarting on change) its own
+    char* errMsg = nullptr;
+    if (sqlite3_exec(source, "BEGIN; SELECT COUNT(*) FROM sqlite_master;",
+                     nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        errorMessage = std::string("Cannot start backup snapshot: ") + (errMsg ? errMsg : "");
+        sqlite3_free(errMsg);
+        sqlite3_close(source);
+        return State::FAILED;
+    }
+
+    sqlite3* target = nullptr;
+    if (sqlite3_open(partialPath.c_str(), &target) != SQLITE_OK) {
+        errorMessage = std::string("Cannot create backup database: ") + sqlite3_errmsg(target);
+        sqlite3_close(target);
+        sqlite3_exec(source, "COMMIT;", nullptr, nullptr, nullptr);
+        sqlite3_close(source);
+        return State::FAILED;
+    }
+
+    State result = State::FAILED;
+    sqlite3_backup* backup = sqlite3_backup_init(target, "main", source, "main");
+    if (!backup) {
+        errorMessage = std::string("Cannot initialize backup: ") + sqlite3_errmsg(target);
+    } else {
+        int rc = SQLITE_OK;
+        while (true) {
+            if (cancelRequested) {
+                result = State::CANCELLED;
+                break;
+            }
+
+            rc = sqlite3_backup_step(backup, pagesPerStep);
+            totalPages = sqlite3_backup_pagecount(backup);
+            remainingPages = sqlite3_backup_remaining(backup);
+
+            if (rc == SQLITE_DONE) {
+                result = State::COMPLETED;
+                break;
+            }
+            if (rc != SQLITE_OK && rc != SQLITE_BUSY && rc != SQLITE_LOCKED) {
+                errorMessage = std::string("Backup step failed: ") + sqlite3_errstr(rc);
+                break;
+            }
+
+            // Give the disk (and other threads) room between steps
+            std::this_thread::sleep_for(stepPause);
+        }
+
+        rc = sqlite3_backup_finish(backup);
+        if (result == State::COMPLETED && rc != SQLITE_OK) {
+            errorMessage = std::string("Backup finish failed: ") + sqlite3_errstr(rc);
+            result = State::FAILED;
+        }
+    }
+
+    sqlite3_close(target);
+    sqlite3_exec(source, "COMMIT;", nullptr, nullptr, nullptr);
+    sqlite3_close(source);
+    return result;
+}
+
+void BackupJob::finish(State result) {
+    if (result == State::FAILED) {
+        std::cerr << "Backup failed: " << errorMessage << std::endl;
+    }
+
+    if (onFinished) {
+        onFinished(result);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        state = result;
+    }
+    finished.notify_all();
+}
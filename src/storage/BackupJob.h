@@ -0,0 +1,81 @@
+#ifndef BACKUP_JOB_H
+#define BACKUP_JOB_H
+
+#include <string>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+
+// Online backup of a WAL database running on its own thread.
+// The job copies from a private read-only connection that holds one read
+// transaction for the whole copy, so it sees a fixed snapshot: concurrent
+// commits neither restart the backup nor wait for it. Pages are copied
+// pagesPerStep at a time with a pause in between, and the result is written
+// to "<target>.part" and renamed into place only once complete.
+class BackupJob {
+public:
+    enum class State {
+        PENDING,
+        RUNNING,
+        COMPLETED,
+        FAILED,
+        CANCELLED
+    };
+
+    // Runs on the backup thread with the final state, before wait() returns
+    using FinishedCallback = std::function<void(State result)>;
+
+    static const int DEFAULT_PAGES_PER_STEP = 256;
+
+private:
+    std::string sourcePath;
+    std::string targetPath;
+    int pagesPerStep;
+    std::chrono::milliseconds stepPause;
+    FinishedCallback onFinished;
+
+    std::atomic<State> state;
+    std::atomic<bool> cancelRequested;
+    std::atomic<int> totalPages;
+    std::atomic<int> remainingPages;
+    std::string errorMessage;   // written before state leaves RUNNING
+
+    std::mutex stateMutex;
+    std::condition_variable finished;
+    std::thread worker;
+
+    void run();
+    State copy();
+    void finish(State result);
+
+public:
+    BackupJob(const std::string& sourcePath, const std::string& targetPath,
+              int pagesPerStep = DEFAULT_PAGES_PER_STEP,
+              std::chrono::milliseconds stepPause = std::chrono::milliseconds(1),
+              FinishedCallback onFinished = nullptr);
+    ~BackupJob();
+
+    BackupJob(const BackupJob&) = delete;
+    BackupJob& operator=(const BackupJob&) = delete;
+
+    void start();
+    // Asks the job to stop after the current step; the partial file is removed
+    void cancel();
+    // Blocks until the job has finished; true if the backup completed
+    bool wait();
+
+    State getState() const { return state.load(); }
+    bool isFinished() const;
+    // Fraction of pages copied so far, 0.0 - 1.0
+    double getProgress() const;
+    int getTotalPages() const { return totalPages.load(); }
+    int getRemainingPages() const { return remainingPages.load(); }
+    const std::string& getTargetPath() const { return targetPath; }
+    // Only meaningful once the job has finished
+    std::string getError() const { return isFinished() ? errorMessage : ""; }
+};
+
+#endif
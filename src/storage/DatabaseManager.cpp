@@ -1,10 +1,14 @@
 #include "DatabaseManager.h"
 #include "../security/SecurityUtils.h"
+#include "FileChecksum.h"
+#include "FileCopy.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <fstream>
 #include <algorithm>
+#include <filesystem>
+#include <unordered_set>
 #include <chrono>
 #include <ctime> // For localtime_s and localtime_r
 
@@ -17,13 +21,57 @@
 #include <unistd.h>
 #endif
 
-DatabaseManager::DatabaseManager(const std::string& dataDir) 
+// Shared by transferPointsWithId and saveTransaction, which use the same cached statement
+static const char* TRANSACTION_INSERT_SQL = R"(
+    INSERT INTO transactions 
+    (transaction_id, from_wallet_id, to_wallet_id, amount, description, transaction_type, timestamp)
+    VALUES (?, ?, ?, ?, ?, ?, ?);
+)";
+
+// Shared by saveUser and importAccounts
+static const char* USER_INSERT_SQL = R"(
+    INSERT INTO users 
+    (user_id, username, password_hash, full_name, email, phone_number, 
+     role, is_password_generated, is_first_login, wallet_id, created_at, last_login)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
+)";
+
+// Shared by the SQL transfer path and ledger materialization
+static const char* WALLET_BALANCE_SQL = "SELECT balance FROM wallets WHERE wallet_id = ?;";
+static const char* WALLET_DEBIT_SQL = "UPDATE wallets SET balance = balance - ? WHERE wallet_id = ?;";
+static const char* WALLET_CREDIT_SQL = "UPDATE wallets SET balance = balance + ? WHERE wallet_id = ?;";
+
+DatabaseManager::DatabaseManager(const std::string& dataDir, size_t readerCount) 
     : db(nullptr), 
       dbPath(dataDir + "/wallet_system.db"),
-      backupDirectory(dataDir + "/backup") {
+      backupDirectory(dataDir + "/backup"),
+      readerCount(readerCount > 0 ? readerCount : 1),
+      idFormat(IdFormat::TEXT),
+      preferredIdFormat(IdFormat::BLOB),
+      backupCatalog(dataDir + "/backup"),
+      pageStore(dataDir + "/backup/pages"),
+      walArchiver(dataDir + "/wallet_system.db", dataDir + "/backup/wal"),
+      transactionArchive(dataDir + "/archive"),
+      walFrames(0),
+      ledgerPath(dataDir + "/ledger.journal"),
+      ledgerMode(false) {
 }
 
 DatabaseManager::~DatabaseManager() {
+    // The backup callback refers to this object, so let it finish first
+    cancelActiveBackup();
+    // Drain queued transfers while the writer connection is still open
+    groupCommitWriter.reset();
+    // Applies what the journal still holds through the writer connection
+    ledger.reset();
+    readerPool.close();
+    {
+        // Closing the last connection checkpoints the WAL; archive it first
+        std::lock_guard<std::mutex> archiveLock(archiveMutex);
+        std::lock_guard<std::mutex> lock(dbMutex);
+        if (db) walArchiver.archive(db);
+    }
+    statementCache.clear();
     if (db) {
         sqlite3_close(db);
         db = nullptr;
@@ -31,6 +79,18 @@ DatabaseManager::~DatabaseManager() {
 }
 
 bool DatabaseManager::initialize() {
+    if (!openDatabase()) {
+        return false;
+    }
+    if (ledgerMode && !openLedger()) {
+        std::cerr << "Failed to open the ledger journal: " << ledgerPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool DatabaseManager::openDatabase() {
+    std::lock_guard<std::mutex> archiveLock(archiveMutex);
     std::lock_guard<std::mutex> lock(dbMutex);
     
     // Create data directory if it doesn't exist
@@ -52,12 +112,59 @@ bool DatabaseManager::initialize() {
         #endif
     }
     
-    // Open SQLite database
+    // Staging files left by an interrupted restore
+    std::remove((dbPath + ".restore").c_str());
+    std::remove((dbPath + ".pitr").c_str());
+    
+    if (!openWriter()) {
+        return false;
+    }
+    
+    // A file without a users table is new and may use the preferred ID format
+    bool isNewDatabase = !tableExists("users");
+    
+    // Create tables
+    if (!createTables()) {
+        std::cerr << "Failed to create database tables" << std::endl;
+        return false;
+    }
+    
+    if (!loadIdFormat(isNewDatabase)) {
+        std::cerr << "Failed to read database ID format" << std::endl;
+        return false;
+    }
+    
+    // Start (or restart, once replay has outgrown it) the WAL archive from
+    // a base snapshot; frames left over from the last run are archived first
+    if (walArchiver.needsBaseSnapshot()) {
+        if (walArchiver.archive(db, SQLITE_CHECKPOINT_TRUNCATE) && walArchiver.createBaseSnapshot(false)) {
+            walArchiver.prune();
+        } else {
+            std::cerr << "Warning: cannot create WAL archive base snapshot" << std::endl;
+        }
+    }
+    sqlite3_wal_hook(db, &DatabaseManager::onWalCommit, this);
+    
+    // Readers are opened after the writer has switched the file to WAL mode
+    if (!readerPool.open(dbPath, readerCount)) {
+        std::cerr << "Failed to open reader connections" << std::endl;
+        return false;
+    }
+    
+    std::cout << "Database initialized successfully: " << dbPath << std::endl;
+    return true;
+}
+
+bool DatabaseManager::openWriter() {
     int rc = sqlite3_open(dbPath.c_str(), &db);
     if (rc != SQLITE_OK) {
         std::cerr << "Cannot open database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        db = nullptr;
         return false;
     }
+    statementCache.reset(db);
+    sqlite3_busy_timeout(db, 5000);
     
     // Enable foreign keys IMMEDIATELY after opening
     char* errMsg = nullptr;
@@ -73,14 +180,6 @@ bool DatabaseManager::initialize() {
         std::cerr << "Failed to enable WAL mode" << std::endl;
         return false;
     }
-    
-    // Create tables
-    if (!createTables()) {
-        std::cerr << "Failed to create database tables" << std::endl;
-        return false;
-    }
-    
-    std::cout << "Database initialized successfully: " << dbPath << std::endl;
     return true;
 }
 
@@ -98,6 +197,31 @@ bool DatabaseManager::enableWALMode() {
     return true;
 }
 
+int DatabaseManager::onWalCommit(void* context, sqlite3* connection, const char* dbName, int walFrames) {
+    (void)dbName;
+    // Runs inside the commit, so the committing thread holds dbMutex
+    DatabaseManager* self = static_cast<DatabaseManager*>(context);
+    self->walArchiver.recordCommit(walFrames);
+    self->walFrames.store(walFrames);
+    
+    // With a maintenance thread running, archiving stays off the commit
+    // path unless that thread falls far behind
+    bool due = self->walArchiver.needsArchive(walFrames);
+    if (due && self->walCheckpointDue) {
+        self->walCheckpointDue();
+        due = walFrames >= WAL_BACKSTOP_FRAMES;
+    }
+    
+    // A base snapshot in progress holds archiveMutex; the WAL then just
+    // grows until the next commit after it finishes
+    if (due && self->archiveMutex.try_lock()) {
+        self->walArchiver.archive(connection);
+        self->walFrames.store(0);
+        self->archiveMutex.unlock();
+    }
+    return SQLITE_OK;
+}
+
 bool DatabaseManager::createTables() {
     const char* userTableSQL = R"(
         CREATE TABLE IF NOT EXISTS users (
@@ -155,11 +279,130 @@ bool DatabaseManager::createTables() {
     const char* indexSQL = R"(
         CREATE INDEX IF NOT EXISTS idx_username ON users(username);
         CREATE INDEX IF NOT EXISTS idx_wallet_owner ON wallets(owner_id);
-        CREATE INDEX IF NOT EXISTS idx_transaction_from ON transactions(from_wallet_id);
-        CREATE INDEX IF NOT EXISTS idx_transaction_to ON transactions(to_wallet_id);
+        DROP INDEX IF EXISTS idx_transaction_from;
+        DROP INDEX IF EXISTS idx_transaction_to;
+        DROP INDEX IF EXISTS idx_transaction_from_time;
+        DROP INDEX IF EXISTS idx_transaction_to_time;
+        CREATE INDEX IF NOT EXISTS idx_transaction_from_cover
+            ON transactions(from_wallet_id, timestamp, transaction_id, to_wallet_id, amount);
+        CREATE INDEX IF NOT EXISTS idx_transaction_to_cover
+            ON transactions(to_wallet_id, timestamp, transaction_id, from_wallet_id, amount);
         CREATE INDEX IF NOT EXISTS idx_otp_expires ON otps(expires_at);
     )";
     
+    // Monthly archive files holding transactions moved out of the hot table
+    const char* archivePartitionsSQL = R"(
+        CREATE TABLE IF NOT EXISTS archive_partitions (
+            month TEXT PRIMARY KEY,
+            file_name TEXT NOT NULL,
+            first_timestamp INTEGER NOT NULL,
+            last_timestamp INTEGER NOT NULL,
+            row_count INTEGER NOT NULL,
+            archived_until INTEGER NOT NULL
+        );
+    )";
+    
+    // One row of running totals, kept current by triggers so statistics
+    // never scan the tables
+    const char* statsSQL = R"(
+        CREATE TABLE IF NOT EXISTS system_stats (
+            id INTEGER PRIMARY KEY CHECK (id = 1),
+            user_count INTEGER NOT NULL,
+            wallet_count INTEGER NOT NULL,
+            transaction_count INTEGER NOT NULL,
+            total_points REAL NOT NULL,
+            locked_wallets INTEGER NOT NULL
+        );
+        CREATE TRIGGER IF NOT EXISTS trg_stats_user_insert AFTER INSERT ON users
+        BEGIN
+            UPDATE system_stats SET user_count = user_count + 1 WHERE id = 1;
+        END;
+        CREATE TRIGGER IF NOT EXISTS trg_stats_user_delete AFTER DELETE ON users
+        BEGIN
+            UPDATE system_stats SET user_count = user_count - 1 WHERE id = 1;
+        END;
+        CREATE TRIGGER IF NOT EXISTS trg_stats_wallet_insert AFTER INSERT ON wallets
+        BEGIN
+            UPDATE system_stats SET wallet_count = wallet_count + 1,
+                total_points = total_points + NEW.balance,
+                locked_wallets = locked_wallets + (NEW.is_locked != 0)
+            WHERE id = 1;
+        END;
+        CREATE TRIGGER IF NOT EXISTS trg_stats_wallet_delete AFTER DELETE ON wallets
+        BEGIN
+            UPDATE system_stats SET wallet_count = wallet_count - 1,
+                total_points = total_points - OLD.balance,
+                locked_wallets = locked_wallets - (OLD.is_locked != 0)
+            WHERE id = 1;
+        END;
+        CREATE TRIGGER IF NOT EXISTS trg_stats_wallet_update AFTER UPDATE OF balance, is_locked ON wallets
+        BEGIN
+            UPDATE system_stats SET total_points = total_points + NEW.balance - OLD.balance,
+                locked_wallets = locked_wallets + (NEW.is_locked != 0) - (OLD.is_locked != 0)
+            WHERE id = 1;
+        END;
+        CREATE TRIGGER IF NOT EXISTS trg_stats_transaction_insert AFTER INSERT ON transactions
+        BEGIN
+            UPDATE system_stats SET transaction_count = transaction_count + 1 WHERE id = 1;
+        END;
+        -- Archiving moves old rows out of the table; they still count
+        DROP TRIGGER IF EXISTS trg_stats_transaction_delete;
+    )";
+    
+    // Existing data is counted once, when the table is first created
+    const char* statsSeedSQL = R"(
+        INSERT INTO system_stats
+            (id, user_count, wallet_count, transaction_count, total_points, locked_wallets)
+        SELECT 1,
+            (SELECT COUNT(*) FROM users),
+            (SELECT COUNT(*) FROM wallets),
+            (SELECT COUNT(*) FROM transactions),
+            (SELECT COALESCE(SUM(balance), 0.0) FROM wallets),
+            (SELECT COUNT(*) FROM wallets WHERE is_locked != 0);
+    )";
+    
+    // Per-wallet flow totals for reports. History is append-only, so one
+    // insert trigger keeps them exact; self-transfers count as inflow only.
+    // Rows exist only for wallets that have history.
+    const char* aggregatesSQL = R"(
+        CREATE TABLE IF NOT EXISTS wallet_aggregates (
+            wallet_id TEXT PRIMARY KEY,
+            total_in REAL NOT NULL DEFAULT 0.0,
+            total_out REAL NOT NULL DEFAULT 0.0,
+            count_in INTEGER NOT NULL DEFAULT 0,
+            count_out INTEGER NOT NULL DEFAULT 0
+        ) WITHOUT ROWID;
+        CREATE TRIGGER IF NOT EXISTS trg_aggregates_transaction_insert AFTER INSERT ON transactions
+        BEGIN
+            INSERT INTO wallet_aggregates (wallet_id, total_in, count_in)
+            SELECT NEW.to_wallet_id, NEW.amount, 1
+            WHERE NEW.to_wallet_id IS NOT NULL
+            ON CONFLICT (wallet_id) DO UPDATE SET
+                total_in = total_in + excluded.total_in,
+                count_in = count_in + 1;
+            INSERT INTO wallet_aggregates (wallet_id, total_out, count_out)
+            SELECT NEW.from_wallet_id, NEW.amount, 1
+            WHERE NEW.from_wallet_id IS NOT NULL AND NEW.from_wallet_id IS NOT NEW.to_wallet_id
+            ON CONFLICT (wallet_id) DO UPDATE SET
+                total_out = total_out + excluded.total_out,
+                count_out = count_out + 1;
+        END;
+    )";
+    
+    const char* aggregatesSeedSQL = R"(
+        INSERT INTO wallet_aggregates (wallet_id, total_in, total_out, count_in, count_out)
+        SELECT wallet_id, SUM(amount_in), SUM(amount_out), SUM(is_in), SUM(1 - is_in)
+        FROM (
+            SELECT to_wallet_id AS wallet_id, amount AS amount_in, 0.0 AS amount_out, 1 AS is_in
+            FROM transactions WHERE to_wallet_id IS NOT NULL
+            UNION ALL
+            SELECT from_wallet_id, 0.0, amount, 0
+            FROM transactions
+            WHERE from_wallet_id IS NOT NULL AND from_wallet_id IS NOT to_wallet_id
+        )
+        GROUP BY wallet_id;
+    )";
+    
     char* errMsg = nullptr;
     
     // Create users table
@@ -194,6 +437,14 @@ bool DatabaseManager::createTables() {
         return false;
     }
     
+    // Create archive partition list
+    rc = sqlite3_exec(db, archivePartitionsSQL, nullptr, nullptr, &errMsg);
+    if (rc != SQLITE_OK) {
+        std::cerr << "Create archive partitions table error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    
     // Create indexes
     rc = sqlite3_exec(db, indexSQL, nullptr, nullptr, &errMsg);
     if (rc != SQLITE_OK) {
@@ -202,6 +453,87 @@ bool DatabaseManager::createTables() {
         return false;
     }
     
+    // Create statistics and aggregate tables with their triggers; seeding
+    // happens in the same transaction so no write can slip in between
+    bool seedStats = !tableExists("system_stats");
+    bool seedAggregates = !tableExists("wallet_aggregates");
+    if (!beginTransaction()) {
+        return false;
+    }
+    rc = sqlite3_exec(db, statsSQL, nullptr, nullptr, &errMsg);
+    if (rc == SQLITE_OK && seedStats) {
+        rc = sqlite3_exec(db, statsSeedSQL, nullptr, nullptr, &errMsg);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_exec(db, aggregatesSQL, nullptr, nullptr, &errMsg);
+    }
+    if (rc == SQLITE_OK && seedAggregates) {
+        rc = sqlite3_exec(db, aggregatesSeedSQL, nullptr, nullptr, &errMsg);
+    }
+    if (rc != SQLITE_OK) {
+        std::cerr << "Create statistics tables error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        rollbackTransaction();
+        return false;
+    }
+    if (!commitTransaction()) {
+        return false;
+    }
+    
+    return true;
+}
+
+bool DatabaseManager::tableExists(const char* tableName) {
+    sqlite3_stmt* stmt = prepareStatement("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;");
+    if (!stmt) return false;
+    
+    sqlite3_bind_text(stmt, 1, tableName, -1, SQLITE_STATIC);
+    bool exists = sqlite3_step(stmt) == SQLITE_ROW;
+    finalizeStatement(stmt);
+    return exists;
+}
+
+bool DatabaseManager::loadIdFormat(bool isNewDatabase) {
+    const char* metaTableSQL = R"(
+        CREATE TABLE IF NOT EXISTS schema_meta (
+            key TEXT PRIMARY KEY,
+            value TEXT NOT NULL
+        );
+    )";
+    
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(db, metaTableSQL, nullptr, nullptr, &errMsg);
+    if (rc != SQLITE_OK) {
+        std::cerr << "Create schema_meta table error: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    
+    sqlite3_stmt* stmt = prepareStatement("SELECT value FROM schema_meta WHERE key = 'id_format';");
+    if (!stmt) return false;
+    
+    bool recorded = false;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        recorded = value && parseIdFormat(value, idFormat);
+        if (!recorded) {
+            std::cerr << "Unknown id_format in schema_meta: " << (value ? value : "NULL") << std::endl;
+        }
+    }
+    finalizeStatement(stmt);
+    
+    if (!recorded) {
+        // Files created before schema_meta existed always hold TEXT IDs
+        idFormat = isNewDatabase ? preferredIdFormat : IdFormat::TEXT;
+        
+        stmt = prepareStatement("INSERT OR REPLACE INTO schema_meta (key, value) VALUES ('id_format', ?);");
+        if (!stmt) return false;
+        sqlite3_bind_text(stmt, 1, idFormatName(idFormat), -1, SQLITE_STATIC);
+        bool saved = executeStatement(stmt);
+        finalizeStatement(stmt);
+        if (!saved) return false;
+    }
+    
     return true;
 }
 
@@ -232,37 +564,42 @@ void DatabaseManager::finalizeStatement(sqlite3_stmt* stmt) {
     }
 }
 
+sqlite3_stmt* DatabaseManager::acquireStatement(StatementId id, const char* sql) const {
+    return statementCache.acquire(id, sql);
+}
+
+void DatabaseManager::releaseStatement(sqlite3_stmt* stmt) const {
+    StatementCache::release(stmt);
+}
+
 bool DatabaseManager::beginTransaction() {
-    char* errMsg = nullptr;
-    int rc = sqlite3_exec(db, "BEGIN TRANSACTION;", nullptr, nullptr, &errMsg);
-    if (rc != SQLITE_OK) {
-        std::cerr << "Begin transaction error: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
-        return false;
+    sqlite3_stmt* stmt = acquireStatement(StatementId::BEGIN_TRANSACTION, "BEGIN TRANSACTION;");
+    bool success = stmt && sqlite3_step(stmt) == SQLITE_DONE;
+    if (!success) {
+        std::cerr << "Begin transaction error: " << sqlite3_errmsg(db) << std::endl;
     }
-    return true;
+    releaseStatement(stmt);
+    return success;
 }
 
 bool DatabaseManager::commitTransaction() {
-    char* errMsg = nullptr;
-    int rc = sqlite3_exec(db, "COMMIT;", nullptr, nullptr, &errMsg);
-    if (rc != SQLITE_OK) {
-        std::cerr << "Commit transaction error: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
-        return false;
+    sqlite3_stmt* stmt = acquireStatement(StatementId::COMMIT_TRANSACTION, "COMMIT;");
+    bool success = stmt && sqlite3_step(stmt) == SQLITE_DONE;
+    if (!success) {
+        std::cerr << "Commit transaction error: " << sqlite3_errmsg(db) << std::endl;
     }
-    return true;
+    releaseStatement(stmt);
+    return success;
 }
 
 bool DatabaseManager::rollbackTransaction() {
-    char* errMsg = nullptr;
-    int rc = sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, &errMsg);
-    if (rc != SQLITE_OK) {
-        std::cerr << "Rollback transaction error: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
-        return false;
+    sqlite3_stmt* stmt = acquireStatement(StatementId::ROLLBACK_TRANSACTION, "ROLLBACK;");
+    bool success = stmt && sqlite3_step(stmt) == SQLITE_DONE;
+    if (!success) {
+        std::cerr << "Rollback transaction error: " << sqlite3_errmsg(db) << std::endl;
     }
-    return true;
+    releaseStatement(stmt);
+    return success;
 }
 
 // ==================== USER MANAGEMENT ====================
@@ -277,18 +614,18 @@ bool DatabaseManager::saveUser(const User& user) {
     
     // Check if user exists first
     const char* checkSql = "SELECT COUNT(*) FROM users WHERE user_id = ?;";
-    sqlite3_stmt* checkStmt = prepareStatement(checkSql);
+    sqlite3_stmt* checkStmt = acquireStatement(StatementId::USER_EXISTS, checkSql);
     if (!checkStmt) {
         rollbackTransaction();
         return false;
     }
     
-    sqlite3_bind_text(checkStmt, 1, user.getUserId().c_str(), -1, SQLITE_STATIC);
+    bindId(checkStmt, 1, user.getUserId(), idFormat);
     bool userExists = false;
     if (sqlite3_step(checkStmt) == SQLITE_ROW) {
         userExists = sqlite3_column_int(checkStmt, 0) > 0;
     }
-    finalizeStatement(checkStmt);
+    releaseStatement(checkStmt);
     
     const char* sql;
     if (userExists) {
@@ -301,16 +638,10 @@ bool DatabaseManager::saveUser(const User& user) {
             WHERE user_id = ?;
         )";
     } else {
-        // Insert new user
-        sql = R"(
-            INSERT INTO users 
-            (user_id, username, password_hash, full_name, email, phone_number, 
-             role, is_password_generated, is_first_login, wallet_id, created_at, last_login)
-            VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
-        )";
+        sql = USER_INSERT_SQL;
     }
     
-    sqlite3_stmt* stmt = prepareStatement(sql);
+    sqlite3_stmt* stmt = acquireStatement(userExists ? StatementId::USER_UPDATE : StatementId::USER_INSERT, sql);
     if (!stmt) {
         rollbackTransaction();
         return false;
@@ -332,28 +663,16 @@ bool DatabaseManager::saveUser(const User& user) {
         sqlite3_bind_int(stmt, 6, static_cast<int>(user.getRole()));
         sqlite3_bind_int(stmt, 7, user.getIsPasswordGenerated() ? 1 : 0);
         sqlite3_bind_int(stmt, 8, user.getIsFirstLogin() ? 1 : 0);
-        sqlite3_bind_text(stmt, 9, user.getWalletId().c_str(), -1, SQLITE_STATIC);
+        bindId(stmt, 9, user.getWalletId(), idFormat);
         sqlite3_bind_int64(stmt, 10, createdAt);
         sqlite3_bind_int64(stmt, 11, lastLogin);
-        sqlite3_bind_text(stmt, 12, user.getUserId().c_str(), -1, SQLITE_STATIC);  // WHERE clause
+        bindId(stmt, 12, user.getUserId(), idFormat);  // WHERE clause
     } else {
-        // Bind parameters for INSERT
-        sqlite3_bind_text(stmt, 1, user.getUserId().c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 2, user.getUsername().c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 3, user.getPasswordHash().c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 4, user.getFullName().c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 5, user.getEmail().c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(stmt, 6, user.getPhoneNumber().c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_int(stmt, 7, static_cast<int>(user.getRole()));
-        sqlite3_bind_int(stmt, 8, user.getIsPasswordGenerated() ? 1 : 0);
-        sqlite3_bind_int(stmt, 9, user.getIsFirstLogin() ? 1 : 0);
-        sqlite3_bind_text(stmt, 10, user.getWalletId().c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_int64(stmt, 11, createdAt);
-        sqlite3_bind_int64(stmt, 12, lastLogin);
+        bindUserInsert(stmt, user);
     }
     
     bool success = executeStatement(stmt);
-    finalizeStatement(stmt);
+    releaseStatement(stmt);
     
     if (success) {
         commitTransaction();
@@ -364,8 +683,123 @@ bool DatabaseManager::saveUser(const User& user) {
     return success;
 }
 
-bool DatabaseManager::saveUser(std::shared_ptr<User> user) {
-    return user ? saveUser(*user) : false;
+void DatabaseManager::bindUserInsert(sqlite3_stmt* stmt, const User& user) {
+    auto createdAt = std::chrono::duration_cast<std::chrono::seconds>(
+        user.getCreatedAt().time_since_epoch()).count();
+    auto lastLogin = std::chrono::duration_cast<std::chrono::seconds>(
+        user.getLastLogin().time_since_epoch()).count();
+    
+    bindId(stmt, 1, user.getUserId(), idFormat);
+    sqlite3_bind_text(stmt, 2, user.getUsername().c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, user.getPasswordHash().c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, user.getFullName().c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 5, user.getEmail().c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 6, user.getPhoneNumber().c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 7, static_cast<int>(user.getRole()));
+    sqlite3_bind_int(stmt, 8, user.getIsPasswordGenerated() ? 1 : 0);
+    sqlite3_bind_int(stmt, 9, user.getIsFirstLogin() ? 1 : 0);
+    bindId(stmt, 10, user.getWalletId(), idFormat);
+    sqlite3_bind_int64(stmt, 11, createdAt);
+    sqlite3_bind_int64(stmt, 12, lastLogin);
+}
+
+bool DatabaseManager::insertAccount(const NewAccount& account, std::string& message) {
+    sqlite3_stmt* userStmt = acquireStatement(StatementId::USER_INSERT, USER_INSERT_SQL);
+    if (!userStmt) {
+        message = "Cannot prepare user insert";
+        return false;
+    }
+    bindUserInsert(userStmt, account.user);
+    int rc = sqlite3_step(userStmt);
+    releaseStatement(userStmt);
+    if (rc != SQLITE_DONE) {
+        // User IDs are fresh UUIDs, so a unique conflict is the username
+        message = sqlite3_errcode(db) == SQLITE_CONSTRAINT ? "Username already exists"
+                                                           : sqlite3_errmsg(db);
+        return false;
+    }
+    
+    const char* walletSql = R"(
+        INSERT INTO wallets (wallet_id, owner_id, balance, created_at, is_locked)
+        VALUES (?, ?, ?, ?, 0);
+    )";
+    sqlite3_stmt* walletStmt = acquireStatement(StatementId::WALLET_INSERT, walletSql);
+    if (!walletStmt) {
+        message = "Cannot prepare wallet insert";
+        return false;
+    }
+    bindId(walletStmt, 1, account.user.getWalletId(), idFormat);
+    bindId(walletStmt, 2, account.user.getUserId(), idFormat);
+    sqlite3_bind_double(walletStmt, 3, account.initialBalance);
+    sqlite3_bind_int64(walletStmt, 4, std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    rc = sqlite3_step(walletStmt);
+    releaseStatement(walletStmt);
+    if (rc != SQLITE_DONE) {
+        message = "Cannot create wallet: " + std::string(sqlite3_errmsg(db));
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::string> DatabaseManager::importAccounts(const std::vector<NewAccount>& accounts) {
+    std::vector<std::string> messages(accounts.size());
+    if (accounts.empty()) {
+        return messages;
+    }
+    
+    std::lock_guard<std::mutex> lock(dbMutex);
+    
+    if (!db || !beginTransaction()) {
+        std::fill(messages.begin(), messages.end(), "Cannot begin import transaction");
+        return messages;
+    }
+    
+    // Rebuilding an index sorts the whole table, which only beats updating
+    // it row by row when the import is about as large as the table. The
+    // count is read inside the transaction, so it is the one the import sees
+    bool deferIndexes = false;
+    if (accounts.size() >= INDEX_REBUILD_MIN_ACCOUNTS) {
+        sqlite3_stmt* stmt = acquireStatement(StatementId::WALLET_COUNT_SELECT,
+                                              "SELECT wallet_count FROM system_stats WHERE id = 1;");
+        if (stmt && sqlite3_step(stmt) == SQLITE_ROW) {
+            deferIndexes = static_cast<sqlite3_int64>(accounts.size()) >= sqlite3_column_int64(stmt, 0);
+        }
+        releaseStatement(stmt);
+    }
+    
+    // Dropped inside the transaction, so a failed import leaves them in place
+    if (deferIndexes &&
+        sqlite3_exec(db, "DROP INDEX IF EXISTS idx_username; DROP INDEX IF EXISTS idx_wallet_owner;",
+                     nullptr, nullptr, nullptr) != SQLITE_OK) {
+        deferIndexes = false;
+    }
+    
+    // A rejected account is rolled back on its own; the rest still commit
+    for (size_t i = 0; i < accounts.size(); ++i) {
+        if (!executeCachedStatement(StatementId::IMPORT_SAVEPOINT_BEGIN, "SAVEPOINT import_account;")) {
+            messages[i] = "Cannot create savepoint";
+            continue;
+        }
+        if (insertAccount(accounts[i], messages[i])) {
+            executeCachedStatement(StatementId::IMPORT_SAVEPOINT_RELEASE, "RELEASE import_account;");
+        } else {
+            executeCachedStatement(StatementId::IMPORT_SAVEPOINT_ROLLBACK, "ROLLBACK TO import_account;");
+            executeCachedStatement(StatementId::IMPORT_SAVEPOINT_RELEASE, "RELEASE import_account;");
+        }
+    }
+    
+    bool rebuilt = !deferIndexes || sqlite3_exec(db, R"(
+        CREATE INDEX IF NOT EXISTS idx_username ON users(username);
+        CREATE INDEX IF NOT EXISTS idx_wallet_owner ON wallets(owner_id);
+    )", nullptr, nullptr, nullptr) == SQLITE_OK;
+    
+    if (!rebuilt || !commitTransaction()) {
+        std::cerr << "Account import failed: " << sqlite3_errmsg(db) << std::endl;
+        rollbackTransaction();
+        std::fill(messages.begin(), messages.end(), "Import commit failed");
+    }
+    return messages;
 }
 
 std::unique_ptr<User> DatabaseManager::loadUser(const std::string& username) {
@@ -373,10 +807,11 @@ std::unique_ptr<User> DatabaseManager::loadUser(const std::string& username) {
 }
 
 std::unique_ptr<User> DatabaseManager::loadUserByUsername(const std::string& username) {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    auto reader = readerPool.acquire();
+    if (!reader) return nullptr;
     
     const char* sql = "SELECT * FROM users WHERE username = ?;";
-    sqlite3_stmt* stmt = prepareStatement(sql);
+    sqlite3_stmt* stmt = reader.statements().acquire(StatementId::USER_SELECT_BY_USERNAME, sql);
     if (!stmt) return nullptr;
     
     sqlite3_bind_text(stmt, 1, username.c_str(), -1, SQLITE_STATIC);
@@ -384,7 +819,7 @@ std::unique_ptr<User> DatabaseManager::loadUserByUsername(const std::string& use
     std::unique_ptr<User> user = nullptr;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         user = std::make_unique<User>(
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)), // user_id
+            columnId(stmt, 0),                                           // user_id
             reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), // username
             reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)), // password_hash
             reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)), // full_name
@@ -395,27 +830,28 @@ std::unique_ptr<User> DatabaseManager::loadUserByUsername(const std::string& use
         
         user->setIsPasswordGenerated(sqlite3_column_int(stmt, 7) == 1);
         user->setIsFirstLogin(sqlite3_column_int(stmt, 8) == 1);
-        user->setWalletId(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9)));
+        user->setWalletId(columnId(stmt, 9));
         // Skip setting timestamps for now - User class doesn't provide public setters
     }
     
-    finalizeStatement(stmt);
+    releaseStatement(stmt);
     return user;
 }
 
 std::unique_ptr<User> DatabaseManager::loadUserById(const std::string& userId) {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    auto reader = readerPool.acquire();
+    if (!reader) return nullptr;
     
     const char* sql = "SELECT * FROM users WHERE user_id = ?;";
-    sqlite3_stmt* stmt = prepareStatement(sql);
+    sqlite3_stmt* stmt = reader.statements().acquire(StatementId::USER_SELECT_BY_ID, sql);
     if (!stmt) return nullptr;
     
-    sqlite3_bind_text(stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
+    bindId(stmt, 1, userId, idFormat);
     
     std::unique_ptr<User> user = nullptr;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         user = std::make_unique<User>(
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)), // user_id
+            columnId(stmt, 0),                                           // user_id
             reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), // username
             reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)), // password_hash
             reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)), // full_name
@@ -426,43 +862,98 @@ std::unique_ptr<User> DatabaseManager::loadUserById(const std::string& userId) {
         
         user->setIsPasswordGenerated(sqlite3_column_int(stmt, 7) == 1);
         user->setIsFirstLogin(sqlite3_column_int(stmt, 8) == 1);
-        user->setWalletId(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9)));
+        user->setWalletId(columnId(stmt, 9));
         // Skip setting timestamps for now - User class doesn't provide public setters
     }
     
-    finalizeStatement(stmt);
+    releaseStatement(stmt);
     return user;
 }
 
 std::vector<std::shared_ptr<User>> DatabaseManager::loadAllUsers() {
-    std::lock_guard<std::mutex> lock(dbMutex);
     std::vector<std::shared_ptr<User>> users;
-    
-    const char* sql = "SELECT * FROM users ORDER BY username;";
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return users;
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        auto user = std::make_shared<User>(
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)), // user_id
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), // username
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)), // password_hash
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)), // full_name
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4)), // email
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5)), // phone_number
-            static_cast<UserRole>(sqlite3_column_int(stmt, 6))           // role
-        );
+    forEachUser([&users](const User& user) {
+        users.push_back(std::make_shared<User>(user));
+        return true;
+    });
+    return users;
+}
+
+size_t DatabaseManager::forEachUser(const UserVisitor& visitor, unsigned columns) {
+    // The select list depends on the projection, so this statement is not
+    // cached; it is prepared once per chunk, which is noise next to the
+    // STREAM_CHUNK_SIZE rows it returns.
+    std::string sql = "SELECT username";
+    if (columns & USER_COLUMN_ID) sql += ", user_id";
+    if (columns & USER_COLUMN_PASSWORD_HASH) sql += ", password_hash";
+    if (columns & USER_COLUMN_PROFILE) sql += ", full_name, email, phone_number";
+    if (columns & USER_COLUMN_ROLE) sql += ", role";
+    if (columns & USER_COLUMN_FLAGS) sql += ", is_password_generated, is_first_login";
+    if (columns & USER_COLUMN_WALLET_ID) sql += ", wallet_id";
+    sql += " FROM users WHERE username > ? ORDER BY username LIMIT ?;";
+    
+    std::vector<User> chunk;
+    chunk.reserve(STREAM_CHUNK_SIZE);
+    std::string lastUsername;
+    size_t visited = 0;
+    
+    while (true) {
+        chunk.clear();
+        {
+            auto reader = readerPool.acquire();
+            if (!reader) return visited;
+            
+            sqlite3_stmt* stmt = nullptr;
+            if (sqlite3_prepare_v2(reader.db(), sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+                std::cerr << "SQL prepare error: " << sqlite3_errmsg(reader.db()) << std::endl;
+                return visited;
+            }
+            
+            sqlite3_bind_text(stmt, 1, lastUsername.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(STREAM_CHUNK_SIZE));
+            
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                int column = 0;
+                auto nextText = [stmt, &column]() {
+                    const unsigned char* text = sqlite3_column_text(stmt, column++);
+                    return text ? std::string(reinterpret_cast<const char*>(text)) : std::string();
+                };
+                
+                std::string username = nextText();
+                std::string userId, passwordHash, fullName, email, phoneNumber;
+                UserRole role = UserRole::REGULAR;
+                if (columns & USER_COLUMN_ID) userId = columnId(stmt, column++);
+                if (columns & USER_COLUMN_PASSWORD_HASH) passwordHash = nextText();
+                if (columns & USER_COLUMN_PROFILE) {
+                    fullName = nextText();
+                    email = nextText();
+                    phoneNumber = nextText();
+                }
+                if (columns & USER_COLUMN_ROLE) {
+                    role = static_cast<UserRole>(sqlite3_column_int(stmt, column++));
+                }
+                
+                chunk.emplace_back(userId, username, passwordHash, fullName, email, phoneNumber, role);
+                User& user = chunk.back();
+                if (columns & USER_COLUMN_FLAGS) {
+                    user.setIsPasswordGenerated(sqlite3_column_int(stmt, column++) == 1);
+                    user.setIsFirstLogin(sqlite3_column_int(stmt, column++) == 1);
+                }
+                if (columns & USER_COLUMN_WALLET_ID) user.setWalletId(columnId(stmt, column++));
+                // Skip setting timestamps for now - User class doesn't provide public setters
+            }
+            
+            sqlite3_finalize(stmt);
+        }
         
-        user->setIsPasswordGenerated(sqlite3_column_int(stmt, 7) == 1);
-        user->setIsFirstLogin(sqlite3_column_int(stmt, 8) == 1);
-        user->setWalletId(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 9)));
-        // Skip setting timestamps for now - User class doesn't provide public setters
+        for (const auto& user : chunk) {
+            ++visited;
+            if (!visitor(user)) return visited;
+        }
         
-        users.push_back(user);
+        if (chunk.size() < STREAM_CHUNK_SIZE) return visited;
+        lastUsername = chunk.back().getUsername();
     }
-    
-    finalizeStatement(stmt);
-    return users;
 }
 
 bool DatabaseManager::updateUser(const User& user) {
@@ -476,15 +967,15 @@ bool DatabaseManager::deleteUser(const std::string& userId) {
     
     // Delete user (wallet will be deleted by foreign key cascade)
     const char* sql = "DELETE FROM users WHERE user_id = ?;";
-    sqlite3_stmt* stmt = prepareStatement(sql);
+    sqlite3_stmt* stmt = acquireStatement(StatementId::USER_DELETE, sql);
     if (!stmt) {
         rollbackTransaction();
         return false;
     }
     
-    sqlite3_bind_text(stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
+    bindId(stmt, 1, userId, idFormat);
     bool success = executeStatement(stmt);
-    finalizeStatement(stmt);
+    releaseStatement(stmt);
     
     if (success) {
         commitTransaction();
@@ -512,20 +1003,37 @@ bool DatabaseManager::saveWallet(const Wallet& wallet) {
     }
     
     const char* sql = R"(
-        INSERT OR REPLACE INTO wallets 
+        INSERT INTO wallets 
+        (wallet_id, owner_id, balance, created_at, is_locked)
+        VALUES (?, ?, ?, ?, ?)
+        ON CONFLICT (wallet_id) DO UPDATE SET
+            owner_id = excluded.owner_id,
+            balance = excluded.balance,
+            is_locked = excluded.is_locked;
+    )";
+    
+    // In ledger mode the journal owns balances: a wallet saved from memory
+    // may be behind it, so only a new wallet takes the given balance
+    const char* keepBalanceSql = R"(
+        INSERT INTO wallets 
         (wallet_id, owner_id, balance, created_at, is_locked)
-        VALUES (?, ?, ?, ?, ?);
+        VALUES (?, ?, ?, ?, ?)
+        ON CONFLICT (wallet_id) DO UPDATE SET
+            owner_id = excluded.owner_id,
+            is_locked = excluded.is_locked;
     )";
     
-    sqlite3_stmt* stmt = prepareStatement(sql);
+    sqlite3_stmt* stmt = ledger
+        ? acquireStatement(StatementId::WALLET_UPSERT_KEEP_BALANCE, keepBalanceSql)
+        : acquireStatement(StatementId::WALLET_UPSERT, sql);
     if (!stmt) {
         std::cerr << "[ERROR] Failed to prepare statement!" << std::endl;
         rollbackTransaction();
         return false;
     }
     
-    sqlite3_bind_text(stmt, 1, wallet.getWalletId().c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, wallet.getOwnerId().c_str(), -1, SQLITE_STATIC);
+    bindId(stmt, 1, wallet.getWalletId(), idFormat);
+    bindId(stmt, 2, wallet.getOwnerId(), idFormat);
     sqlite3_bind_double(stmt, 3, wallet.getBalance());
     // Set current timestamp for created_at
     auto now = std::chrono::duration_cast<std::chrono::seconds>(
@@ -534,7 +1042,7 @@ bool DatabaseManager::saveWallet(const Wallet& wallet) {
     sqlite3_bind_int(stmt, 5, wallet.getIsLocked() ? 1 : 0);
     
     bool success = executeStatement(stmt);
-    finalizeStatement(stmt);
+    releaseStatement(stmt);
     
     if (success) {
         commitTransaction();
@@ -545,24 +1053,21 @@ bool DatabaseManager::saveWallet(const Wallet& wallet) {
     return success;
 }
 
-bool DatabaseManager::saveWallet(std::shared_ptr<Wallet> wallet) {
-    return wallet ? saveWallet(*wallet) : false;
-}
-
 std::shared_ptr<Wallet> DatabaseManager::loadWallet(const std::string& walletId) {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    auto reader = readerPool.acquire();
+    if (!reader) return nullptr;
     
     const char* sql = "SELECT * FROM wallets WHERE wallet_id = ?;";
-    sqlite3_stmt* stmt = prepareStatement(sql);
+    sqlite3_stmt* stmt = reader.statements().acquire(StatementId::WALLET_SELECT_BY_ID, sql);
     if (!stmt) return nullptr;
     
-    sqlite3_bind_text(stmt, 1, walletId.c_str(), -1, SQLITE_STATIC);
+    bindId(stmt, 1, walletId, idFormat);
     
     std::shared_ptr<Wallet> wallet = nullptr;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         wallet = std::make_shared<Wallet>(
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)), // wallet_id
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), // owner_id
+            columnId(stmt, 0),                                           // wallet_id
+            columnId(stmt, 1),                                           // owner_id
             sqlite3_column_double(stmt, 2)                               // balance
         );
         
@@ -570,36 +1075,37 @@ std::shared_ptr<Wallet> DatabaseManager::loadWallet(const std::string& walletId)
         wallet->setLocked(sqlite3_column_int(stmt, 4) == 1);
         
         // Load transactions for this wallet
-        auto transactions = loadWalletTransactions(walletId);
+        auto transactions = loadWalletTransactions(reader.statements(), walletId);
         for (const auto& tx : transactions) {
             wallet->addTransaction(tx);
         }
     }
     
-    finalizeStatement(stmt);
+    releaseStatement(stmt);
     return wallet;
 }
 
 std::shared_ptr<Wallet> DatabaseManager::loadWalletByOwnerId(const std::string& ownerId) {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    auto reader = readerPool.acquire();
+    if (!reader) return nullptr;
     
     const char* sql = "SELECT * FROM wallets WHERE owner_id = ?;";
-    sqlite3_stmt* stmt = prepareStatement(sql);
+    sqlite3_stmt* stmt = reader.statements().acquire(StatementId::WALLET_SELECT_BY_OWNER, sql);
     if (!stmt) {
         return nullptr;
     }
     
-    sqlite3_bind_text(stmt, 1, ownerId.c_str(), -1, SQLITE_STATIC);
+    bindId(stmt, 1, ownerId, idFormat);
     
     std::shared_ptr<Wallet> wallet = nullptr;
     int result = sqlite3_step(stmt);
     
     if (result == SQLITE_ROW) {
-        std::string walletId = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        std::string walletId = columnId(stmt, 0);
         
         wallet = std::make_shared<Wallet>(
             walletId,                                                    // wallet_id
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), // owner_id
+            columnId(stmt, 1),                                           // owner_id
             sqlite3_column_double(stmt, 2)                               // balance
         );
         
@@ -607,44 +1113,71 @@ std::shared_ptr<Wallet> DatabaseManager::loadWalletByOwnerId(const std::string&
         wallet->setLocked(sqlite3_column_int(stmt, 4) == 1);
         
         // Load transactions for this wallet
-        auto transactions = loadWalletTransactions(walletId);
+        auto transactions = loadWalletTransactions(reader.statements(), walletId);
         for (const auto& tx : transactions) {
             wallet->addTransaction(tx);
         }
     }
     
-    finalizeStatement(stmt);
+    releaseStatement(stmt);
     return wallet;
 }
 
 std::vector<std::shared_ptr<Wallet>> DatabaseManager::loadAllWallets() {
-    std::lock_guard<std::mutex> lock(dbMutex);
     std::vector<std::shared_ptr<Wallet>> wallets;
-    
-    const char* sql = "SELECT * FROM wallets ORDER BY wallet_id;";
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return wallets;
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        std::string walletId = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        auto wallet = std::make_shared<Wallet>(
-            walletId,                                                    // wallet_id
-            reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), // owner_id
-            sqlite3_column_double(stmt, 2)                               // balance
-        );
+    forEachWallet([&wallets](const Wallet& wallet) {
+        wallets.push_back(std::make_shared<Wallet>(wallet));
+        return true;
+    });
+    return wallets;
+}
+
+size_t DatabaseManager::forEachWallet(const WalletVisitor& visitor) {
+    const char* sql = "SELECT * FROM wallets WHERE wallet_id > ? ORDER BY wallet_id LIMIT ?;";
+    
+    std::vector<Wallet> chunk;
+    chunk.reserve(STREAM_CHUNK_SIZE);
+    std::string lastWalletId;
+    size_t visited = 0;
+    
+    while (true) {
+        chunk.clear();
+        {
+            auto reader = readerPool.acquire();
+            if (!reader) return visited;
+            
+            sqlite3_stmt* stmt = reader.statements().acquire(StatementId::WALLET_SCAN_CHUNK, sql);
+            if (!stmt) return visited;
+            
+            bindId(stmt, 1, lastWalletId, idFormat);
+            sqlite3_bind_int64(stmt, 2, static_cast<sqlite3_int64>(STREAM_CHUNK_SIZE));
+            
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                chunk.emplace_back(
+                    columnId(stmt, 0),                                           // wallet_id
+                    columnId(stmt, 1),                                           // owner_id
+                    sqlite3_column_double(stmt, 2)                               // balance
+                );
+                
+                // Skip setting created_at since Wallet doesn't have setter
+                chunk.back().setLocked(sqlite3_column_int(stmt, 4) == 1);
+            }
+            
+            releaseStatement(stmt);
+        }
         
-        // Skip setting created_at since Wallet doesn't have setter
-        wallet->setLocked(sqlite3_column_int(stmt, 4) == 1);
+        for (const auto& wallet : chunk) {
+            ++visited;
+            if (!visitor(wallet)) return visited;
+        }
         
-        wallets.push_back(wallet);
+        if (chunk.size() < STREAM_CHUNK_SIZE) return visited;
+        lastWalletId = chunk.back().getId();
     }
-    
-    finalizeStatement(stmt);
-    return wallets;
 }
 
 bool DatabaseManager::updateWallet(const Wallet& wallet) {
-    return saveWallet(wallet); // INSERT OR REPLACE handles updates
+    return saveWallet(wallet); // the upsert handles updates
 }
 
 bool DatabaseManager::transferPoints(const std::string& fromWalletId, 
@@ -660,132 +1193,358 @@ std::string DatabaseManager::transferPointsWithId(const std::string& fromWalletI
                                                   const std::string& toWalletId, 
                                                   double amount, 
                                                   const std::string& description) {
+    if (ledger) {
+        std::vector<TransferResult> results = ledger->append(
+            {TransferRequest{fromWalletId, toWalletId, amount, description, ""}});
+        return results[0].success ? results[0].transactionId : "";
+    }
+    
     std::lock_guard<std::mutex> lock(dbMutex);
     
     if (!beginTransaction()) return "";
     
     try {
-        // Get source wallet balance
-        const char* checkSql = "SELECT balance FROM wallets WHERE wallet_id = ?;";
-        sqlite3_stmt* checkStmt = prepareStatement(checkSql);
-        if (!checkStmt) {
+        TransferRequest request{fromWalletId, toWalletId, amount, description, ""};
+        TransferResult result;
+        
+        if (!executeTransferLeg(request, result)) {
             rollbackTransaction();
             return "";
         }
         
-        sqlite3_bind_text(checkStmt, 1, fromWalletId.c_str(), -1, SQLITE_STATIC);
-        
-        double fromBalance = 0.0;
-        if (sqlite3_step(checkStmt) == SQLITE_ROW) {
-            fromBalance = sqlite3_column_double(checkStmt, 0);
-        } else {
-            finalizeStatement(checkStmt);
+        if (!commitTransaction()) {
             rollbackTransaction();
             return "";
         }
-        finalizeStatement(checkStmt);
+        return result.transactionId;
         
-        if (fromBalance < amount) {
-            rollbackTransaction();
-            return ""; // Insufficient funds
+    } catch (const std::exception& e) {
+        rollbackTransaction();
+        return "";
+    }
+}
+
+std::vector<TransferResult> DatabaseManager::transferPointsBatch(const std::vector<TransferRequest>& requests) {
+    std::vector<TransferResult> results(requests.size(), TransferResult{false, "", "", 0.0});
+    if (requests.empty()) {
+        return results;
+    }
+    if (ledger) {
+        return ledger->append(requests);
+    }
+    
+    std::lock_guard<std::mutex> lock(dbMutex);
+    
+    if (!beginTransaction()) {
+        for (auto& result : results) {
+            result.message = "Cannot begin batch transaction";
         }
-        
-        // Update source wallet
-        const char* debitSql = "UPDATE wallets SET balance = balance - ? WHERE wallet_id = ?;";
-        sqlite3_stmt* debitStmt = prepareStatement(debitSql);
-        if (!debitStmt) {
-            rollbackTransaction();
-            return "";
+        return results;
+    }
+    
+    try {
+        for (size_t i = 0; i < requests.size(); ++i) {
+            // Each leg runs inside its own savepoint so a failing transfer
+            // is undone without discarding the rest of the batch
+            if (!executeCachedStatement(StatementId::SAVEPOINT_BEGIN, "SAVEPOINT transfer_leg;")) {
+                results[i].message = "Cannot create savepoint";
+                continue;
+            }
+            
+            if (executeTransferLeg(requests[i], results[i])) {
+                executeCachedStatement(StatementId::SAVEPOINT_RELEASE, "RELEASE transfer_leg;");
+            } else {
+                executeCachedStatement(StatementId::SAVEPOINT_ROLLBACK, "ROLLBACK TO transfer_leg;");
+                executeCachedStatement(StatementId::SAVEPOINT_RELEASE, "RELEASE transfer_leg;");
+            }
         }
         
-        sqlite3_bind_double(debitStmt, 1, amount);
-        sqlite3_bind_text(debitStmt, 2, fromWalletId.c_str(), -1, SQLITE_STATIC);
-        
-        if (!executeStatement(debitStmt)) {
-            finalizeStatement(debitStmt);
+        if (!commitTransaction()) {
             rollbackTransaction();
-            return "";
+            for (auto& result : results) {
+                result.success = false;
+                result.transactionId.clear();
+                result.message = "Batch commit failed";
+            }
         }
-        finalizeStatement(debitStmt);
-        
-        // Update destination wallet
-        const char* creditSql = "UPDATE wallets SET balance = balance + ? WHERE wallet_id = ?;";
-        sqlite3_stmt* creditStmt = prepareStatement(creditSql);
-        if (!creditStmt) {
-            rollbackTransaction();
-            return "";
+    } catch (const std::exception& e) {
+        rollbackTransaction();
+        for (auto& result : results) {
+            result.success = false;
+            result.transactionId.clear();
+            result.message = "Batch aborted: " + std::string(e.what());
         }
-        
-        sqlite3_bind_double(creditStmt, 1, amount);
-        sqlite3_bind_text(creditStmt, 2, toWalletId.c_str(), -1, SQLITE_STATIC);
-        
-        if (!executeStatement(creditStmt)) {
-            finalizeStatement(creditStmt);
-            rollbackTransaction();
-            return "";
+    }
+    
+    return results;
+}
+
+std::future<TransferResult> DatabaseManager::submitTransfer(const TransferRequest& request,
+                                                            TransferCallback onCommitted) {
+    {
+        std::lock_guard<std::mutex> lock(groupCommitMutex);
+        if (!groupCommitWriter) {
+            groupCommitWriter.reset(new GroupCommitWriter(
+                [this](const std::vector<TransferRequest>& requests) {
+                    return transferPointsBatch(requests);
+                }));
         }
-        finalizeStatement(creditStmt);
-        
-        // Record transaction directly (no separate transaction needed since we're already in one)
-        std::string transactionId = SecurityUtils::generateUUID();
-        
-        const char* transSql = R"(
-            INSERT INTO transactions 
-            (transaction_id, from_wallet_id, to_wallet_id, amount, description, transaction_type, timestamp)
-            VALUES (?, ?, ?, ?, ?, ?, ?);
-        )";
-        
-        sqlite3_stmt* transStmt = prepareStatement(transSql);
-        if (!transStmt) {
-            rollbackTransaction();
-            return "";
+    }
+    
+    return groupCommitWriter->submit(request, onCommitted);
+}
+
+bool DatabaseManager::executeCachedStatement(StatementId id, const char* sql) {
+    sqlite3_stmt* stmt = acquireStatement(id, sql);
+    bool success = stmt && executeStatement(stmt);
+    releaseStatement(stmt);
+    return success;
+}
+
+bool DatabaseManager::executeTransferLeg(const TransferRequest& request, TransferResult& result) {
+    result.success = false;
+    
+    if (request.amount <= 0) {
+        result.message = "Amount must be positive";
+        return false;
+    }
+    
+    // Get source wallet balance
+    sqlite3_stmt* checkStmt = acquireStatement(StatementId::WALLET_BALANCE, WALLET_BALANCE_SQL);
+    if (!checkStmt) {
+        result.message = "Cannot prepare balance query";
+        return false;
+    }
+    
+    bindId(checkStmt, 1, request.fromWalletId, idFormat);
+    
+    double fromBalance = 0.0;
+    if (sqlite3_step(checkStmt) == SQLITE_ROW) {
+        fromBalance = sqlite3_column_double(checkStmt, 0);
+    } else {
+        releaseStatement(checkStmt);
+        result.message = "Source wallet not found";
+        return false;
+    }
+    releaseStatement(checkStmt);
+    
+    if (fromBalance < request.amount) {
+        result.message = "Insufficient balance";
+        return false;
+    }
+    
+    // Update source wallet
+    sqlite3_stmt* debitStmt = acquireStatement(StatementId::WALLET_DEBIT, WALLET_DEBIT_SQL);
+    if (!debitStmt) {
+        result.message = "Cannot prepare debit";
+        return false;
+    }
+    
+    sqlite3_bind_double(debitStmt, 1, request.amount);
+    bindId(debitStmt, 2, request.fromWalletId, idFormat);
+    
+    bool debited = executeStatement(debitStmt);
+    releaseStatement(debitStmt);
+    if (!debited) {
+        result.message = "Debit failed";
+        return false;
+    }
+    
+    // Update destination wallet
+    sqlite3_stmt* creditStmt = acquireStatement(StatementId::WALLET_CREDIT, WALLET_CREDIT_SQL);
+    if (!creditStmt) {
+        result.message = "Cannot prepare credit";
+        return false;
+    }
+    
+    sqlite3_bind_double(creditStmt, 1, request.amount);
+    bindId(creditStmt, 2, request.toWalletId, idFormat);
+    
+    bool credited = executeStatement(creditStmt) && sqlite3_changes(db) > 0;
+    releaseStatement(creditStmt);
+    if (!credited) {
+        result.message = "Destination wallet not found";
+        return false;
+    }
+    
+    // Record transaction directly (no separate transaction needed since we're already in one)
+    std::string transactionId = SecurityUtils::generateUUID();
+    
+    sqlite3_stmt* transStmt = acquireStatement(StatementId::TRANSACTION_INSERT, TRANSACTION_INSERT_SQL);
+    if (!transStmt) {
+        result.message = "Cannot prepare transaction insert";
+        return false;
+    }
+    
+    auto now = std::chrono::system_clock::now();
+    
+    bindId(transStmt, 1, transactionId, idFormat);
+    bindId(transStmt, 2, request.fromWalletId, idFormat);
+    bindId(transStmt, 3, request.toWalletId, idFormat);
+    sqlite3_bind_double(transStmt, 4, request.amount);
+    sqlite3_bind_text(transStmt, 5, request.description.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(transStmt, 6, static_cast<int>(TransactionType::TRANSFER));
+    sqlite3_bind_int64(transStmt, 7, std::chrono::duration_cast<std::chrono::seconds>(
+        now.time_since_epoch()).count());
+    
+    bool recorded = executeStatement(transStmt);
+    releaseStatement(transStmt);
+    if (!recorded) {
+        result.message = "Cannot record transaction";
+        return false;
+    }
+    
+    result.success = true;
+    result.message = "Transfer completed";
+    result.transactionId = transactionId;
+    result.newBalance = fromBalance - request.amount;
+    return true;
+}
+
+// ==================== LEDGER MODE ====================
+
+void DatabaseManager::setLedgerMode(bool enabled) {
+    ledgerMode = enabled;
+}
+
+bool DatabaseManager::isLedgerMode() const {
+    return ledgerMode;
+}
+
+bool DatabaseManager::flushLedger() {
+    return !ledger || ledger->flush();
+}
+
+bool DatabaseManager::openLedger() {
+    uint64_t sequence = 0;
+    {
+        std::lock_guard<std::mutex> lock(dbMutex);
+        sqlite3_stmt* stmt = prepareStatement("SELECT value FROM schema_meta WHERE key = 'ledger_sequence';");
+        if (!stmt) return false;
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            sequence = static_cast<uint64_t>(sqlite3_column_int64(stmt, 0));
         }
-        
-        auto now = std::chrono::system_clock::now();
-        
-        sqlite3_bind_text(transStmt, 1, transactionId.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(transStmt, 2, fromWalletId.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_text(transStmt, 3, toWalletId.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_double(transStmt, 4, amount);
-        sqlite3_bind_text(transStmt, 5, description.c_str(), -1, SQLITE_STATIC);
-        sqlite3_bind_int(transStmt, 6, static_cast<int>(TransactionType::TRANSFER));
-        sqlite3_bind_int64(transStmt, 7, std::chrono::duration_cast<std::chrono::seconds>(
-            now.time_since_epoch()).count());
-        
-        if (!executeStatement(transStmt)) {
-            finalizeStatement(transStmt);
+        finalizeStatement(stmt);
+    }
+    
+    std::unique_ptr<TransferLedger> opened(new TransferLedger(ledgerPath,
+        [this](const std::string& walletId, double& balance) {
+            return loadLedgerBalance(walletId, balance);
+        },
+        [this](const std::vector<LedgerEntry>& entries) {
+            return materializeLedgerEntries(entries);
+        }));
+    if (!opened->open(sequence)) {
+        return false;
+    }
+    ledger = std::move(opened);
+    std::cout << "Ledger journal opened: " << ledgerPath << std::endl;
+    return true;
+}
+
+bool DatabaseManager::loadLedgerBalance(const std::string& walletId, double& balance) {
+    auto reader = readerPool.acquire();
+    if (!reader) return false;
+    
+    sqlite3_stmt* stmt = reader.statements().acquire(StatementId::WALLET_BALANCE, WALLET_BALANCE_SQL);
+    if (!stmt) return false;
+    
+    bindId(stmt, 1, walletId, idFormat);
+    bool found = sqlite3_step(stmt) == SQLITE_ROW;
+    if (found) {
+        balance = sqlite3_column_double(stmt, 0);
+    }
+    releaseStatement(stmt);
+    return found;
+}
+
+bool DatabaseManager::materializeLedgerEntries(const std::vector<LedgerEntry>& entries) {
+    if (entries.empty()) return true;
+    
+    std::lock_guard<std::mutex> lock(dbMutex);
+    if (!db || !beginTransaction()) return false;
+    
+    for (const auto& entry : entries) {
+        if (!executeCachedStatement(StatementId::LEDGER_SAVEPOINT_BEGIN, "SAVEPOINT ledger_entry;")) {
             rollbackTransaction();
-            return "";
+            return false;
         }
-        finalizeStatement(transStmt);
-        
-        commitTransaction();
-        return transactionId;
-        
-    } catch (const std::exception& e) {
+        if (applyLedgerEntry(entry)) {
+            executeCachedStatement(StatementId::LEDGER_SAVEPOINT_RELEASE, "RELEASE ledger_entry;");
+        } else {
+            // Only possible if a wallet was deleted after the transfer was
+            // accepted; retrying would never succeed
+            std::cerr << "Journaled transfer " << entry.transactionId
+                      << " cannot be applied and is skipped" << std::endl;
+            executeCachedStatement(StatementId::LEDGER_SAVEPOINT_ROLLBACK, "ROLLBACK TO ledger_entry;");
+            executeCachedStatement(StatementId::LEDGER_SAVEPOINT_RELEASE, "RELEASE ledger_entry;");
+        }
+    }
+    
+    sqlite3_stmt* stmt = acquireStatement(StatementId::LEDGER_SEQUENCE_UPDATE,
+        "INSERT OR REPLACE INTO schema_meta (key, value) VALUES ('ledger_sequence', ?);");
+    if (!stmt) {
         rollbackTransaction();
-        return "";
+        return false;
+    }
+    sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(entries.back().sequence));
+    bool recorded = executeStatement(stmt);
+    releaseStatement(stmt);
+    
+    if (!recorded || !commitTransaction()) {
+        rollbackTransaction();
+        return false;
     }
+    return true;
+}
+
+bool DatabaseManager::applyLedgerEntry(const LedgerEntry& entry) {
+    sqlite3_stmt* debitStmt = acquireStatement(StatementId::WALLET_DEBIT, WALLET_DEBIT_SQL);
+    if (!debitStmt) return false;
+    sqlite3_bind_double(debitStmt, 1, entry.amount);
+    bindId(debitStmt, 2, entry.fromWalletId, idFormat);
+    bool debited = executeStatement(debitStmt) && sqlite3_changes(db) > 0;
+    releaseStatement(debitStmt);
+    if (!debited) return false;
+    
+    sqlite3_stmt* creditStmt = acquireStatement(StatementId::WALLET_CREDIT, WALLET_CREDIT_SQL);
+    if (!creditStmt) return false;
+    sqlite3_bind_double(creditStmt, 1, entry.amount);
+    bindId(creditStmt, 2, entry.toWalletId, idFormat);
+    bool credited = executeStatement(creditStmt) && sqlite3_changes(db) > 0;
+    releaseStatement(creditStmt);
+    if (!credited) return false;
+    
+    sqlite3_stmt* transStmt = acquireStatement(StatementId::TRANSACTION_INSERT, TRANSACTION_INSERT_SQL);
+    if (!transStmt) return false;
+    bindId(transStmt, 1, entry.transactionId, idFormat);
+    bindId(transStmt, 2, entry.fromWalletId, idFormat);
+    bindId(transStmt, 3, entry.toWalletId, idFormat);
+    sqlite3_bind_double(transStmt, 4, entry.amount);
+    sqlite3_bind_text(transStmt, 5, entry.description.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(transStmt, 6, static_cast<int>(TransactionType::TRANSFER));
+    sqlite3_bind_int64(transStmt, 7, entry.timestamp);
+    bool recorded = executeStatement(transStmt);
+    releaseStatement(transStmt);
+    return recorded;
 }
 
 std::string DatabaseManager::getMasterWalletId() {
-    std::lock_guard<std::mutex> lock(dbMutex);
+    auto reader = readerPool.acquire();
+    if (!reader) return "";
     
     const char* sql = "SELECT wallet_id FROM users WHERE is_first_login = 1 LIMIT 1;";
-    sqlite3_stmt* stmt = prepareStatement(sql);
+    sqlite3_stmt* stmt = reader.statements().acquire(StatementId::MASTER_WALLET_ID, sql);
     if (!stmt) {
         return "";
     }
     
     std::string masterWalletId;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
-        const char* walletId = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        if (walletId) {
-            masterWalletId = walletId;
-        }
+        masterWalletId = columnId(stmt, 0);
     }
     
-    finalizeStatement(stmt);
+    releaseStatement(stmt);
     return masterWalletId;
 }
 
@@ -795,75 +1554,523 @@ bool DatabaseManager::saveTransaction(const Transaction& transaction) {
     std::lock_guard<std::mutex> lock(dbMutex);
     
     // Insert the transaction directly - SQLite will handle foreign key constraints
-    const char* sql = R"(
-        INSERT INTO transactions 
-        (transaction_id, from_wallet_id, to_wallet_id, amount, description, transaction_type, timestamp)
-        VALUES (?, ?, ?, ?, ?, ?, ?);
-    )";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
+    sqlite3_stmt* stmt = acquireStatement(StatementId::TRANSACTION_INSERT, TRANSACTION_INSERT_SQL);
     if (!stmt) {
         return false;
     }
     
-    sqlite3_bind_text(stmt, 1, transaction.getId().c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, transaction.getFromWalletId().c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, transaction.getToWalletId().c_str(), -1, SQLITE_STATIC);
+    bindId(stmt, 1, transaction.getId(), idFormat);
+    bindId(stmt, 2, transaction.getFromWalletId(), idFormat);
+    bindId(stmt, 3, transaction.getToWalletId(), idFormat);
     sqlite3_bind_double(stmt, 4, transaction.getAmount());
-    sqlite3_bind_text(stmt, 5, transaction.getDescription().c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 5, transaction.getDescription().c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_int(stmt, 6, static_cast<int>(transaction.getType()));
     sqlite3_bind_int64(stmt, 7, std::chrono::duration_cast<std::chrono::seconds>(
         transaction.getTimestamp().time_since_epoch()).count());
     
     bool success = executeStatement(stmt);
-    finalizeStatement(stmt);
+    releaseStatement(stmt);
     
     return success;
 }
 
+// Builds a Transaction from a `SELECT * FROM transactions` row
+static Transaction readTransactionRow(sqlite3_stmt* stmt) {
+    auto textColumn = [stmt](int column) {
+        const unsigned char* text = sqlite3_column_text(stmt, column);
+        return text ? std::string(reinterpret_cast<const char*>(text)) : std::string();
+    };
+    
+    Transaction transaction(columnId(stmt, 0),                                       // transaction_id
+                            columnId(stmt, 1),                                       // from_wallet_id
+                            columnId(stmt, 2),                                       // to_wallet_id
+                            sqlite3_column_double(stmt, 3),                          // amount
+                            static_cast<TransactionType>(sqlite3_column_int(stmt, 5)),
+                            TransactionStatus::COMPLETED,
+                            textColumn(4));                                          // description
+    transaction.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::seconds(sqlite3_column_int64(stmt, 6)));
+    return transaction;
+}
+
 std::vector<Transaction> DatabaseManager::loadWalletTransactions(const std::string& walletId) {
+    return loadHistory(walletId, HistoryCursor(), -1);
+}
+
+std::vector<Transaction> DatabaseManager::loadWalletTransactions(StatementCache& statements,
+                                                                const std::string& walletId) {
     std::vector<Transaction> transactions;
     
+    // Both arms already come out of their covering index in the final
+    // order, so SQLite merges them instead of sorting the whole history
     const char* sql = R"(
-        SELECT * FROM transactions 
-        WHERE from_wallet_id = ? OR to_wallet_id = ? 
-        ORDER BY timestamp DESC;
+        SELECT * FROM transactions WHERE from_wallet_id = ?1
+        UNION ALL
+        SELECT * FROM transactions WHERE to_wallet_id = ?1 AND from_wallet_id IS NOT ?1
+        ORDER BY timestamp DESC, transaction_id DESC;
     )";
     
-    sqlite3_stmt* stmt = prepareStatement(sql);
+    sqlite3_stmt* stmt = statements.acquire(StatementId::TRANSACTION_SELECT_BY_WALLET, sql);
     if (!stmt) return transactions;
     
-    sqlite3_bind_text(stmt, 1, walletId.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, walletId.c_str(), -1, SQLITE_STATIC);
+    bindId(stmt, 1, walletId, idFormat);
     
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        std::string transactionId = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        std::string fromWalletId = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        std::string toWalletId = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        double amount = sqlite3_column_double(stmt, 3);
-        std::string description = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
-        TransactionType type = static_cast<TransactionType>(sqlite3_column_int(stmt, 5));
+        transactions.push_back(readTransactionRow(stmt));
+    }
+    
+    releaseStatement(stmt);
+    return transactions;
+}
+
+std::vector<Transaction> DatabaseManager::loadHistory(const std::string& walletId,
+                                                      const HistoryCursor& cursor, int64_t limit) {
+    std::vector<Transaction> transactions;
+    std::vector<TransactionArchive::Partition> partitions;
+    int64_t watermark = 0;
+    {
+        auto reader = readerPool.acquire();
+        if (!reader) return transactions;
+        StatementCache& statements = reader.statements();
+        
+        // The hot rows and the watermark must come from one snapshot: an
+        // archive run committing in between would move rows past both
+        sqlite3_stmt* stmt = statements.acquire(StatementId::BEGIN_TRANSACTION, "BEGIN TRANSACTION;");
+        bool inSnapshot = stmt && sqlite3_step(stmt) == SQLITE_DONE;
+        releaseStatement(stmt);
+        if (!inSnapshot) return transactions;
         
-        // auto timestamp = std::chrono::system_clock::from_time_t(sqlite3_column_int64(stmt, 6));  // Unused for now
+        // Each arm walks its covering index backwards from the cursor and the
+        // merge stops after `limit` rows, so the cost depends on the page
+        // size rather than on the wallet's history length.
+        const char* sql = R"(
+            SELECT * FROM transactions
+            WHERE from_wallet_id = ?1 AND (timestamp, transaction_id) < (?2, ?3)
+            UNION ALL
+            SELECT * FROM transactions
+            WHERE to_wallet_id = ?1 AND from_wallet_id IS NOT ?1
+              AND (timestamp, transaction_id) < (?2, ?3)
+            ORDER BY timestamp DESC, transaction_id DESC LIMIT ?4;
+        )";
         
-        transactions.emplace_back(transactionId, fromWalletId, toWalletId, amount, 
-                                type, TransactionStatus::COMPLETED, description);
+        stmt = statements.acquire(StatementId::TRANSACTION_PAGE_BY_WALLET, sql);
+        if (stmt) {
+            bindId(stmt, 1, walletId, idFormat);
+            sqlite3_bind_int64(stmt, 2, cursor.timestamp);
+            bindId(stmt, 3, cursor.transactionId, idFormat);
+            sqlite3_bind_int64(stmt, 4, limit);
+            
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                transactions.push_back(readTransactionRow(stmt));
+            }
+            releaseStatement(stmt);
+        }
+        
+        transactionArchive.loadPartitions(reader.db(), partitions, watermark);
+        
+        stmt = statements.acquire(StatementId::COMMIT_TRANSACTION, "COMMIT;");
+        if (stmt) sqlite3_step(stmt);
+        releaseStatement(stmt);
     }
     
-    finalizeStatement(stmt);
+    // Hot rows are normally all newer than the watermark, but rows inserted
+    // with an older timestamp may interleave, so each source is read up to
+    // `limit` and the union is sorted and trimmed
+    size_t hotRows = transactions.size();
+    // A full page of hot rows only leaves room for archived rows from the
+    // same second as its oldest row or later, so archives are normally
+    // opened only once the hot rows run out
+    int64_t oldestNeeded = INT64_MIN;
+    if (limit >= 0 && static_cast<int64_t>(hotRows) >= limit && hotRows > 0) {
+        oldestNeeded = std::chrono::duration_cast<std::chrono::seconds>(
+            transactions.back().getTimestamp().time_since_epoch()).count();
+    }
+    int64_t archivedRows = 0;
+    for (const auto& partition : partitions) {
+        if (limit >= 0 && archivedRows >= limit) break;
+        // Partitions are newest first, so none after this one can qualify
+        if (partition.lastTimestamp < oldestNeeded) break;
+        if (partition.firstTimestamp >= watermark || partition.firstTimestamp > cursor.timestamp) continue;
+        
+        size_t before = transactions.size();
+        loadArchivedTransactions(partition, walletId, cursor, watermark,
+                                 limit < 0 ? -1 : limit - archivedRows, transactions);
+        archivedRows += static_cast<int64_t>(transactions.size() - before);
+    }
+    
+    if (transactions.size() > hotRows) {
+        // Same key as the SQL and the cursor, so rows sharing a second
+        // keep the order the next page continues from
+        std::sort(transactions.begin(), transactions.end(),
+                  [](const Transaction& a, const Transaction& b) {
+                      if (a.getTimestamp() != b.getTimestamp()) {
+                          return a.getTimestamp() > b.getTimestamp();
+                      }
+                      return a.getId() > b.getId();
+                  });
+        if (limit >= 0 && static_cast<int64_t>(transactions.size()) > limit) {
+            transactions.resize(static_cast<size_t>(limit));
+        }
+    }
     return transactions;
 }
 
-// ==================== BACKUP MANAGEMENT ====================
+bool DatabaseManager::loadArchivedTransactions(const TransactionArchive::Partition& partition,
+                                               const std::string& walletId,
+                                               const HistoryCursor& cursor, int64_t watermark,
+                                               int64_t limit, std::vector<Transaction>& transactions) {
+    sqlite3* archive = TransactionArchive::openPartition(partition);
+    if (!archive) return false;
+    
+    // Rows at or above the watermark are leftovers of an interrupted run
+    // that are still in the hot table
+    const char* sql = R"(
+        SELECT * FROM transactions
+        WHERE from_wallet_id = ?1 AND (timestamp, transaction_id) < (?2, ?3) AND timestamp < ?4
+        UNION ALL
+        SELECT * FROM transactions
+        WHERE to_wallet_id = ?1 AND from_wallet_id IS NOT ?1
+          AND (timestamp, transaction_id) < (?2, ?3) AND timestamp < ?4
+        ORDER BY timestamp DESC, transaction_id DESC LIMIT ?5;
+    )";
+    
+    sqlite3_stmt* stmt = nullptr;
+    bool success = sqlite3_prepare_v2(archive, sql, -1, &stmt, nullptr) == SQLITE_OK;
+    if (success) {
+        bindId(stmt, 1, walletId, idFormat);
+        sqlite3_bind_int64(stmt, 2, cursor.timestamp);
+        bindId(stmt, 3, cursor.transactionId, idFormat);
+        sqlite3_bind_int64(stmt, 4, watermark);
+        sqlite3_bind_int64(stmt, 5, limit);
+        
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            transactions.push_back(readTransactionRow(stmt));
+        }
+        success = rc == SQLITE_DONE;
+    }
+    if (!success) {
+        std::cerr << "Cannot read transaction archive " << partition.path << ": "
+                  << sqlite3_errmsg(archive) << std::endl;
+    }
+    
+    sqlite3_finalize(stmt);
+    sqlite3_close(archive);
+    return success;
+}
 
-bool DatabaseManager::createBackup(const std::string& description, BackupType type) {
-    (void)description; // Suppress warning - parameter reserved for future use
-    (void)type;        // Suppress warning - parameter reserved for future use
+// Both arms come out of their covering index in timestamp order, so the
+// wallet export is a merge rather than a sort; the unfiltered export reads
+// the table in storage order
+static const char* EXPORT_ALL_SQL =
+    "SELECT * FROM transactions WHERE timestamp >= ?2 AND timestamp < ?3;";
+static const char* EXPORT_WALLET_SQL = R"(
+    SELECT * FROM transactions
+    WHERE from_wallet_id = ?1 AND timestamp >= ?2 AND timestamp < ?3
+    UNION ALL
+    SELECT * FROM transactions
+    WHERE to_wallet_id = ?1 AND from_wallet_id IS NOT ?1 AND timestamp >= ?2 AND timestamp < ?3
+    ORDER BY timestamp, transaction_id;
+)";
+
+// Runs one export query on `db` into `exporter`
+static bool exportQuery(sqlite3* db, TransactionExporter& exporter, IdFormat idFormat,
+                        const TransactionExportFilter& filter, int64_t until) {
+    const char* sql = filter.walletId.empty() ? EXPORT_ALL_SQL : EXPORT_WALLET_SQL;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Cannot prepare export query: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    if (!filter.walletId.empty()) {
+        bindId(stmt, 1, filter.walletId, idFormat);
+    }
+    sqlite3_bind_int64(stmt, 2, filter.from);
+    sqlite3_bind_int64(stmt, 3, until);
+    
+    bool success = exporter.writeRows(stmt);
+    sqlite3_finalize(stmt);
+    return success;
+}
+
+int64_t DatabaseManager::exportTransactions(const std::string& path, ExportFormat format,
+                                            const TransactionExportFilter& filter) {
+    if (filter.from >= filter.until) {
+        std::cerr << "Export range is empty" << std::endl;
+        return -1;
+    }
+    
+    auto reader = readerPool.acquire();
+    if (!reader) return -1;
+    StatementCache& statements = reader.statements();
+    
+    // As in loadHistory, the hot rows and the watermark come from one
+    // snapshot so no row is written twice or skipped by an archive run
+    sqlite3_stmt* stmt = statements.acquire(StatementId::BEGIN_TRANSACTION, "BEGIN TRANSACTION;");
+    bool inSnapshot = stmt && sqlite3_step(stmt) == SQLITE_DONE;
+    releaseStatement(stmt);
+    if (!inSnapshot) return -1;
+    
+    std::vector<TransactionArchive::Partition> partitions;
+    int64_t watermark = 0;
+    transactionArchive.loadPartitions(reader.db(), partitions, watermark);
+    
+    TransactionExporter exporter(path, format);
+    bool opened = exporter.open();
+    bool success = opened;
+    
+    // Only archived rows below the watermark are authoritative
+    int64_t archivedUntil = std::min(watermark, filter.until);
+    for (auto it = partitions.rbegin(); success && it != partitions.rend(); ++it) {
+        if (it->firstTimestamp >= archivedUntil || it->lastTimestamp < filter.from) continue;
+        
+        sqlite3* archive = TransactionArchive::openPartition(*it);
+        if (!archive) {
+            success = false;
+            break;
+        }
+        success = exportQuery(archive, exporter, idFormat, filter, archivedUntil);
+        sqlite3_close(archive);
+    }
     
+    if (success) {
+        success = exportQuery(reader.db(), exporter, idFormat, filter, filter.until);
+    }
+    
+    stmt = statements.acquire(StatementId::COMMIT_TRANSACTION, "COMMIT;");
+    if (stmt) sqlite3_step(stmt);
+    releaseStatement(stmt);
+    
+    if (!opened) return -1;
+    if (!exporter.close() || !success) {
+        std::remove(path.c_str());
+        return -1;
+    }
+    return exporter.getRowCount();
+}
+
+TransactionPage DatabaseManager::loadTransactionPage(const std::string& walletId,
+                                                     const HistoryCursor& cursor,
+                                                     size_t pageSize) {
+    TransactionPage page;
+    if (pageSize == 0) return page;
+    
+    // One extra row tells whether another page follows
+    page.transactions = loadHistory(walletId, cursor, static_cast<int64_t>(pageSize) + 1);
+    if (page.transactions.size() > pageSize) {
+        page.hasMore = true;
+        page.transactions.resize(pageSize);
+    }
+    
+    if (!page.transactions.empty()) {
+        const Transaction& last = page.transactions.back();
+        page.nextCursor.timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+            last.getTimestamp().time_since_epoch()).count();
+        page.nextCursor.transactionId = last.getId();
+    } else {
+        page.nextCursor = cursor;
+    }
+    return page;
+}
+
+int DatabaseManager::getArchiveHotDays() {
     std::lock_guard<std::mutex> lock(dbMutex);
+    if (!db) return 0;
     
+    sqlite3_stmt* stmt = prepareStatement("SELECT value FROM schema_meta WHERE key = 'archive_hot_days';");
+    if (!stmt) return 0;
+    int days = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        days = std::max(0, sqlite3_column_int(stmt, 0));
+    }
+    finalizeStatement(stmt);
+    return days;
+}
+
+bool DatabaseManager::setArchiveHotDays(int days) {
+    if (days < 0) return false;
+    
+    std::lock_guard<std::mutex> lock(dbMutex);
     if (!db) return false;
-      // Generate backup filename
+    
+    sqlite3_stmt* stmt = prepareStatement(
+        "INSERT OR REPLACE INTO schema_meta (key, value) VALUES ('archive_hot_days', ?);");
+    if (!stmt) return false;
+    sqlite3_bind_int(stmt, 1, days);
+    bool saved = executeStatement(stmt);
+    finalizeStatement(stmt);
+    return saved;
+}
+
+int DatabaseManager::archiveOldTransactions(int hotDays) {
+    if (hotDays < 0) return -1;
+    int64_t cutoff = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() - int64_t(hotDays) * 86400;
+    
+    // The write lock is released between months so transfers are not held
+    // up for the whole run
+    int total = 0;
+    while (true) {
+        int moved;
+        {
+            std::lock_guard<std::mutex> lock(dbMutex);
+            if (!db) return -1;
+            moved = transactionArchive.archiveOldestMonth(db, cutoff);
+        }
+        if (moved < 0) return -1;
+        if (moved == 0) break;
+        total += moved;
+    }
+    
+    if (total > 0) {
+        std::cout << "Archived " << total << " transactions older than " << hotDays << " days" << std::endl;
+    }
+    return total;
+}
+
+WalletFlowSummary DatabaseManager::loadWalletFlowSummary(const std::string& walletId) {
+    WalletFlowSummary summary;
+    
+    auto reader = readerPool.acquire();
+    if (!reader) return summary;
+    
+    // One primary-key lookup; a wallet without history has no row
+    const char* sql = R"(
+        SELECT total_in, count_in, total_out, count_out
+        FROM wallet_aggregates WHERE wallet_id = ?;
+    )";
+    
+    sqlite3_stmt* stmt = reader.statements().acquire(StatementId::WALLET_AGGREGATES_SELECT, sql);
+    if (!stmt) return summary;
+    
+    bindId(stmt, 1, walletId, idFormat);
+    
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        summary.totalIn = sqlite3_column_double(stmt, 0);
+        summary.countIn = sqlite3_column_int(stmt, 1);
+        summary.totalOut = sqlite3_column_double(stmt, 2);
+        summary.countOut = sqlite3_column_int(stmt, 3);
+    }
+    
+    releaseStatement(stmt);
+    return summary;
+}
+
+// ==================== OTP MANAGEMENT ====================
+
+bool DatabaseManager::saveOTP(const std::string& userId, const std::string& purpose,
+                              const std::string& otpCode, int64_t expiresAt) {
+    std::lock_guard<std::mutex> lock(dbMutex);
+    
+    // Replaces any previous code for the same user and purpose
+    const char* sql = R"(
+        INSERT INTO otps (user_id, purpose, otp_code, expires_at) VALUES (?, ?, ?, ?)
+        ON CONFLICT (user_id, purpose)
+        DO UPDATE SET otp_code = excluded.otp_code, expires_at = excluded.expires_at;
+    )";
+    sqlite3_stmt* stmt = acquireStatement(StatementId::OTP_UPSERT, sql);
+    if (!stmt) return false;
+    
+    bindId(stmt, 1, userId, idFormat);
+    sqlite3_bind_text(stmt, 2, purpose.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, otpCode.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 4, expiresAt);
+    
+    bool success = executeStatement(stmt);
+    releaseStatement(stmt);
+    return success;
+}
+
+std::string DatabaseManager::loadOTP(const std::string& userId, const std::string& purpose,
+                                     int64_t now) {
+    std::lock_guard<std::mutex> lock(dbMutex);
+    
+    const char* sql = "SELECT otp_code FROM otps WHERE user_id = ? AND purpose = ? AND expires_at >= ?;";
+    sqlite3_stmt* stmt = acquireStatement(StatementId::OTP_SELECT, sql);
+    if (!stmt) return "";
+    
+    bindId(stmt, 1, userId, idFormat);
+    sqlite3_bind_text(stmt, 2, purpose.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 3, now);
+    
+    std::string otp;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        otp = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    }
+    
+    releaseStatement(stmt);
+    return otp;
+}
+
+bool DatabaseManager::consumeOTP(const std::string& userId, const std::string& purpose,
+                                 const std::string& otpCode, int64_t now) {
+    std::lock_guard<std::mutex> lock(dbMutex);
+    
+    // Check and delete in one statement so a code can never be used twice
+    const char* sql = R"(
+        DELETE FROM otps
+        WHERE user_id = ? AND purpose = ? AND otp_code = ? AND expires_at >= ?
+        RETURNING 1;
+    )";
+    sqlite3_stmt* stmt = acquireStatement(StatementId::OTP_CONSUME, sql);
+    if (!stmt) return false;
+    
+    bindId(stmt, 1, userId, idFormat);
+    sqlite3_bind_text(stmt, 2, purpose.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, otpCode.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 4, now);
+    
+    // RETURNING applies the whole delete on the first step
+    bool consumed = sqlite3_step(stmt) == SQLITE_ROW;
+    
+    releaseStatement(stmt);
+    return consumed;
+}
+
+void DatabaseManager::removeOTP(const std::string& userId, const std::string& purpose) {
+    std::lock_guard<std::mutex> lock(dbMutex);
+    
+    const char* sql = "DELETE FROM otps WHERE user_id = ? AND purpose = ?;";
+    sqlite3_stmt* stmt = acquireStatement(StatementId::OTP_DELETE, sql);
+    if (!stmt) return;
+    
+    bindId(stmt, 1, userId, idFormat);
+    sqlite3_bind_text(stmt, 2, purpose.c_str(), -1, SQLITE_STATIC);
+    executeStatement(stmt);
+    releaseStatement(stmt);
+}
+
+int DatabaseManager::removeExpiredOTPs(int64_t now) {
+    std::lock_guard<std::mutex> lock(dbMutex);
+    
+    const char* sql = "DELETE FROM otps WHERE expires_at < ?;";
+    sqlite3_stmt* stmt = acquireStatement(StatementId::OTP_DELETE_EXPIRED, sql);
+    if (!stmt) return 0;
+    
+    sqlite3_bind_int64(stmt, 1, now);
+    int removed = executeStatement(stmt) ? sqlite3_changes(db) : 0;
+    releaseStatement(stmt);
+    return removed;
+}
+
+// ==================== BACKUP MANAGEMENT ====================
+
+bool DatabaseManager::createBackup(const std::string& description, BackupType type) {
+    auto job = startBackup(description, type);
+    return job && job->wait();
+}
+
+std::shared_ptr<BackupJob> DatabaseManager::startBackup(const std::string& description,
+                                                        BackupType type) {
+    if (!db) return nullptr;
+    
+    std::lock_guard<std::mutex> lock(backupMutex);
+    if (activeBackup && !activeBackup->isFinished()) {
+        std::cerr << "A backup is already in progress" << std::endl;
+        return nullptr;
+    }
+    
+    // Generate backup filename
     auto now = std::chrono::system_clock::now();
     auto time_t_val = std::chrono::system_clock::to_time_t(now);
     
@@ -878,158 +2085,505 @@ bool DatabaseManager::createBackup(const std::string& description, BackupType ty
     ss << ".db";
     std::string backupPath = ss.str();
     
-    // Use SQLite backup API
-    sqlite3* backupDb;
-    int rc = sqlite3_open(backupPath.c_str(), &backupDb);
-    if (rc != SQLITE_OK) {
-        std::cerr << "Cannot create backup database: " << sqlite3_errmsg(backupDb) << std::endl;
-        return false;
-    }
-    
-    sqlite3_backup* backup = sqlite3_backup_init(backupDb, "main", db, "main");
-    if (!backup) {
-        std::cerr << "Cannot initialize backup: " << sqlite3_errmsg(backupDb) << std::endl;
-        sqlite3_close(backupDb);
-        return false;
-    }
-    
-    rc = sqlite3_backup_step(backup, -1);
-    if (rc != SQLITE_DONE) {
-        std::cerr << "Backup failed: " << sqlite3_errmsg(backupDb) << std::endl;
-        sqlite3_backup_finish(backup);
-        sqlite3_close(backupDb);
-        return false;
-    }
-    
-    sqlite3_backup_finish(backup);
-    sqlite3_close(backupDb);
-    
     // Create backup info
     BackupInfo info;
     info.backupId = SecurityUtils::generateUUID();
     info.filename = backupPath;
     info.type = type;
     info.timestamp = now;
-    info.fileSize = 0; // You could calculate actual file size here
-    info.checksum = ""; // You could calculate checksum here
-    
-    backupHistory.push_back(info);
+    info.fileSize = 0;
+    info.description = description;
+    
+    // The job copies through its own connection, so dbMutex is never taken.
+    // Size and checksum are computed on the backup thread once the copy is done.
+    auto job = std::make_shared<BackupJob>(dbPath, backupPath, BackupJob::DEFAULT_PAGES_PER_STEP,
+                                           std::chrono::milliseconds(1),
+        [this, info](BackupJob::State result) mutable {
+            if (result != BackupJob::State::COMPLETED) return;
+            
+            FileDigest digest = FileChecksum::compute(info.filename);
+            if (digest.ok) {
+                info.fileSize = static_cast<size_t>(digest.size);
+                info.checksum = digest.checksum;
+            } else {
+                std::cerr << "Cannot checksum backup: " << info.filename << std::endl;
+            }
+            
+            // Only pages not already stored are kept; the full copy goes away
+            std::string manifestPath = pageStore.ingest(info.filename, info.backupId);
+            if (!manifestPath.empty()) {
+                std::remove(info.filename.c_str());
+                info.filename = manifestPath;
+            }
+            
+            std::lock_guard<std::mutex> historyLock(backupMutex);
+            if (!backupCatalog.add(info)) {
+                std::cerr << "Cannot record backup in manifest: " << info.filename << std::endl;
+            }
+            std::cout << "Database backup created: " << info.filename << std::endl;
+        });
     
-    std::cout << "Database backup created: " << backupPath << std::endl;
-    return true;
+    activeBackup = job;
+    activeBackupId = info.backupId;
+    job->start();
+    return job;
+}
+
+std::shared_ptr<BackupJob> DatabaseManager::getActiveBackup() const {
+    std::lock_guard<std::mutex> lock(backupMutex);
+    return activeBackup;
+}
+
+void DatabaseManager::cancelActiveBackup() {
+    std::shared_ptr<BackupJob> job = getActiveBackup();
+    if (job) {
+        job->cancel();
+        job->wait();
+    }
 }
 
 bool DatabaseManager::restoreFromBackup(const std::string& backupId) {
     // Find backup
-    auto it = std::find_if(backupHistory.begin(), backupHistory.end(),
-        [&backupId](const BackupInfo& info) {
-            return info.backupId == backupId;
-        });
+    BackupInfo backup;
+    {
+        std::lock_guard<std::mutex> historyLock(backupMutex);
+        if (!backupCatalog.find(backupId, backup)) {
+            std::cerr << "Backup not found: " << backupId << std::endl;
+            return false;
+        }
+    }
     
-    if (it == backupHistory.end()) {
-        std::cerr << "Backup not found: " << backupId << std::endl;
+    // A running backup would keep reading the file being replaced
+    cancelActiveBackup();
+    
+    // Page-store backups are rebuilt next to the database and moved into place
+    std::string sourcePath = backup.filename;
+    bool staged = PageStore::isManifest(backup.filename);
+    if (staged) {
+        sourcePath = dbPath + ".restore";
+        if (!pageStore.materialize(backup.filename, sourcePath)) {
+            std::cerr << "Cannot rebuild backup from page store: " << backup.backupId << std::endl;
+            std::remove(sourcePath.c_str());
+            return false;
+        }
+    }
+    
+    // Refuse to restore a truncated or corrupted file; backups made before
+    // checksums were recorded have none and are restored as-is
+    if (!backup.checksum.empty() &&
+        !FileChecksum::verify(sourcePath, backup.fileSize, backup.checksum)) {
+        std::cerr << "Backup checksum mismatch, restore aborted: " << backup.filename << std::endl;
+        if (staged) std::remove(sourcePath.c_str());
         return false;
     }
     
-    std::lock_guard<std::mutex> lock(dbMutex);
+    auto replace = [&]() {
+        std::lock_guard<std::mutex> archiveLock(archiveMutex);
+        std::lock_guard<std::mutex> lock(dbMutex);
+        
+        if (!replaceDatabaseFile(sourcePath, staged)) {
+            return false;
+        }
+        
+        // History after this point no longer follows the archived WAL
+        if (walArchiver.createBaseSnapshot(true)) {
+            walArchiver.prune();
+        }
+        return true;
+    };
+    
+    // In ledger mode the journal is applied to the old file first and then
+    // emptied, since none of it belongs to the restored one
+    if (!(ledger ? ledger->rebase(replace) : replace())) {
+        if (staged) std::remove(sourcePath.c_str());
+        return false;
+    }
     
-    // Close current database
+    std::cout << "Database restored from backup: " << backup.filename << std::endl;
+    return true;
+}
+
+bool DatabaseManager::replaceDatabaseFile(const std::string& sourcePath, bool consumeSource) {
+    // Stage the complete file next to the live one before touching the open
+    // database, so a failed copy leaves it as it was
+    std::string stagedPath = sourcePath;
+    if (!consumeSource) {
+        stagedPath = dbPath + ".restore";
+        if (!FileCopy::copy(sourcePath, stagedPath)) {
+            std::cerr << "Cannot copy backup file" << std::endl;
+            std::remove(stagedPath.c_str());
+            return false;
+        }
+    }
+    if (!FileCopy::sync(stagedPath)) {
+        std::cerr << "Cannot flush restored database to disk" << std::endl;
+        std::remove(stagedPath.c_str());
+        return false;
+    }
+    
+    // Keep everything committed so far in the WAL archive
     if (db) {
-        sqlite3_close(db);
+        walArchiver.archive(db);
+    }
+    
+    // Close current database (cached statements must be finalized first).
+    // Every committed frame is checkpointed into the file and the WAL
+    // truncated before the close; if either fails the old database stays
+    // open as it was, since dropping its WAL would lose commits.
+    readerPool.close();
+    statementCache.clear();
+    if (db) {
+        int rc = sqlite3_wal_checkpoint_v2(db, nullptr, SQLITE_CHECKPOINT_TRUNCATE, nullptr, nullptr);
+        if (rc == SQLITE_OK) {
+            rc = sqlite3_close(db);
+        }
+        if (rc != SQLITE_OK) {
+            std::cerr << "Cannot close database for restore: " << sqlite3_errmsg(db) << std::endl;
+            std::remove(stagedPath.c_str());
+            if (!readerPool.open(dbPath, readerCount)) {
+                std::cerr << "Cannot reopen reader connections" << std::endl;
+            }
+            return false;
+        }
         db = nullptr;
     }
     
-    // Copy backup file to main database
-    std::ifstream src(it->filename, std::ios::binary);
-    std::ofstream dst(dbPath, std::ios::binary);
+    // The rename is atomic: after a crash the path holds either the old,
+    // fully checkpointed file or the new one, never a partial copy
+    bool swapped = FileCopy::replace(stagedPath, dbPath);
+    if (swapped) {
+        // A WAL left next to the new file would be replayed into it on open
+        std::remove((dbPath + "-wal").c_str());
+        std::remove((dbPath + "-shm").c_str());
+    } else {
+        std::cerr << "Cannot move restored database into place" << std::endl;
+        std::remove(stagedPath.c_str());
+    }
     
-    if (!src || !dst) {
-        std::cerr << "Cannot copy backup file" << std::endl;
+    // Reopen whichever file is now in place
+    if (!openWriter()) {
+        std::cerr << "Cannot reopen database after restore" << std::endl;
         return false;
     }
-    
-    dst << src.rdbuf();
-    src.close();
-    dst.close();
-    
-    // Reopen database
-    int rc = sqlite3_open(dbPath.c_str(), &db);
-    if (rc != SQLITE_OK) {
-        std::cerr << "Cannot reopen database after restore: " << sqlite3_errmsg(db) << std::endl;
+
+    // Older backups lack the statistics table and its triggers
+    if (!createTables()) {
+        std::cerr << "Cannot update schema of restored database" << std::endl;
+        return false;
+    }
+
+    // Backups taken before schema_meta existed are TEXT-keyed
+    if (!loadIdFormat(false)) {
+        std::cerr << "Cannot read ID format of restored database" << std::endl;
         return false;
     }
     
-    enableWALMode();
+    if (!readerPool.open(dbPath, readerCount)) {
+        std::cerr << "Cannot reopen reader connections after restore" << std::endl;
+        return false;
+    }
     
-    std::cout << "Database restored from backup: " << it->filename << std::endl;
-    return true;
+    // The new WAL is archived from its first frame
+    walArchiver.resetWalPosition();
+    sqlite3_wal_hook(db, &DatabaseManager::onWalCommit, this);
+    return swapped;
 }
 
 std::vector<BackupInfo> DatabaseManager::getBackupHistory() const {
-    return backupHistory;
+    std::lock_guard<std::mutex> lock(backupMutex);
+    return backupCatalog.getEntries();
+}
+
+// Marks the newest backup of each of the `periods` most recent periods in
+// a newest-first list; periodOf maps a timestamp to its period number
+template<typename PeriodOf>
+static void keepNewestPerPeriod(const std::vector<BackupInfo>& backups, std::vector<bool>& keep,
+                                int periods, PeriodOf periodOf) {
+    int seen = 0;
+    long long lastPeriod = 0;
+    for (size_t i = 0; i < backups.size() && seen < periods; ++i) {
+        long long period = periodOf(backups[i].timestamp);
+        if (seen == 0 || period != lastPeriod) {
+            keep[i] = true;
+            lastPeriod = period;
+            ++seen;
+        }
+    }
 }
 
 int DatabaseManager::cleanupOldBackups(int keepCount) {
-    if (backupHistory.size() <= static_cast<size_t>(keepCount)) {
+    std::lock_guard<std::mutex> lock(backupMutex);
+    
+    std::vector<BackupInfo> backups = backupCatalog.getEntries();
+    if (keepCount < 0) {
         return 0;
     }
     
-    // Sort by timestamp (newest first)
-    std::sort(backupHistory.begin(), backupHistory.end(),
+    // Sort by timestamp (newest first); the catalog is in creation order,
+    // so reversing it first keeps backups from the same second in order
+    std::reverse(backups.begin(), backups.end());
+    std::stable_sort(backups.begin(), backups.end(),
         [](const BackupInfo& a, const BackupInfo& b) {
             return a.timestamp > b.timestamp;
         });
     
+    std::vector<bool> keep(backups.size(), false);
+    for (size_t i = 0; i < backups.size() && i < static_cast<size_t>(keepCount); ++i) {
+        keep[i] = true;
+    }
+    
+    // Periods are whole UTC days, weeks starting on Monday, and months
+    auto dayOf = [](const std::chrono::system_clock::time_point& time) {
+        return static_cast<long long>(std::chrono::system_clock::to_time_t(time) / 86400);
+    };
+    keepNewestPerPeriod(backups, keep, DAILY_BACKUPS_KEPT, dayOf);
+    keepNewestPerPeriod(backups, keep, WEEKLY_BACKUPS_KEPT,
+        [&dayOf](const std::chrono::system_clock::time_point& time) {
+            return (dayOf(time) + 3) / 7;   // 1970-01-01 was a Thursday
+        });
+    keepNewestPerPeriod(backups, keep, MONTHLY_BACKUPS_KEPT,
+        [](const std::chrono::system_clock::time_point& time) {
+            std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+            std::tm* utc = std::gmtime(&seconds);
+            return utc ? utc->tm_year * 12LL + utc->tm_mon : 0LL;
+        });
+    
+    std::vector<BackupInfo> kept;
     int deletedCount = 0;
-    for (size_t i = keepCount; i < backupHistory.size(); ++i) {
-        if (std::remove(backupHistory[i].filename.c_str()) == 0) {
+    for (size_t i = 0; i < backups.size(); ++i) {
+        if (keep[i]) {
+            kept.push_back(backups[i]);
+        } else if (std::remove(backups[i].filename.c_str()) == 0) {
             deletedCount++;
         }
     }
     
-    backupHistory.resize(keepCount);
+    if (kept.size() == backups.size()) {
+        return 0;
+    }
+    backupCatalog.replaceAll(kept);
+    
+    // Pages that only the deleted backups used are dropped from the store,
+    // along with manifests of backups that were never recorded. A running
+    // backup writes its manifest before its catalog entry, so it is kept
+    std::unordered_set<std::string> backupIds;
+    for (const auto& backup : kept) {
+        backupIds.insert(backup.backupId);
+    }
+    if (activeBackup && !activeBackup->isFinished()) {
+        backupIds.insert(activeBackupId);
+    }
+    pageStore.collectGarbage(backupIds);
     return deletedCount;
 }
 
-// ==================== UTILITY METHODS ====================
+bool DatabaseManager::archiveWal() {
+    std::lock_guard<std::mutex> archiveLock(archiveMutex);
+    std::lock_guard<std::mutex> lock(dbMutex);
+    return db && walArchiver.archive(db);
+}
 
-bool DatabaseManager::isReady() const {
-    return db != nullptr;
+bool DatabaseManager::checkpointWal() {
+    std::lock_guard<std::mutex> archiveLock(archiveMutex);
+    std::lock_guard<std::mutex> lock(dbMutex);
+    if (!db) return false;
+    
+    // PASSIVE checkpoints let SQLite reuse the WAL from the start, but the
+    // file keeps the size of its largest burst until truncated
+    std::error_code ec;
+    uintmax_t walSize = std::filesystem::file_size(dbPath + "-wal", ec);
+    int checkpointMode;
+    if (!ec && walSize > static_cast<uintmax_t>(WAL_SIZE_BUDGET_BYTES)) {
+        checkpointMode = SQLITE_CHECKPOINT_TRUNCATE;
+    } else if (walArchiver.needsArchive(walFrames.load())) {
+        checkpointMode = SQLITE_CHECKPOINT_PASSIVE;
+    } else {
+        return true;
+    }
+    
+    bool success = walArchiver.archive(db, checkpointMode);
+    walFrames.store(0);
+    return success;
 }
 
-std::string DatabaseManager::getStatistics() const {
+void DatabaseManager::setBackgroundCheckpoints(std::function<void()> notify) {
+    // The hook reads it under dbMutex
     std::lock_guard<std::mutex> lock(dbMutex);
+    walCheckpointDue = std::move(notify);
+}
+
+bool DatabaseManager::createBaseSnapshot(bool force) {
+    std::lock_guard<std::mutex> archiveLock(archiveMutex);
+    if (!force && !walArchiver.needsBaseSnapshot()) {
+        return true;
+    }
     
-    if (!db) return "Database not initialized";
+    {
+        std::lock_guard<std::mutex> lock(dbMutex);
+        if (!db || !walArchiver.archive(db, SQLITE_CHECKPOINT_TRUNCATE)) {
+            return false;
+        }
+    }
     
-    std::stringstream ss;
+    // Until archiveMutex is released nothing checkpoints, so writers keep
+    // appending to the WAL while the unchanged database file is copied
+    if (!walArchiver.createBaseSnapshot(false)) {
+        return false;
+    }
+    walArchiver.prune();
+    return true;
+}
+
+std::chrono::system_clock::time_point DatabaseManager::getEarliestRecoveryPoint() {
+    std::lock_guard<std::mutex> archiveLock(archiveMutex);
+    return walArchiver.getEarliestRecoveryPoint();
+}
+
+bool DatabaseManager::restoreToPointInTime(const std::chrono::system_clock::time_point& target) {
+    cancelActiveBackup();
     
-    // Count users
-    const char* userCountSql = "SELECT COUNT(*) FROM users;";
-    sqlite3_stmt* stmt = sqlite3_prepare_v2(db, userCountSql, -1, nullptr, nullptr) == SQLITE_OK ? 
-                         sqlite3_prepare_v2(db, userCountSql, -1, &stmt, nullptr) == SQLITE_OK ? stmt : nullptr : nullptr;
+    auto restore = [&]() {
+        std::lock_guard<std::mutex> archiveLock(archiveMutex);
+        std::lock_guard<std::mutex> lock(dbMutex);
+        if (!db) return false;
+        
+        // Archive the latest commits so that any time up to now can be reached
+        if (!walArchiver.archive(db)) {
+            std::cerr << "Cannot archive WAL before restore" << std::endl;
+            return false;
+        }
+        
+        std::string recoveredPath = dbPath + ".pitr";
+        bool restored = walArchiver.materialize(target, recoveredPath) &&
+                        replaceDatabaseFile(recoveredPath, true);
+        std::remove(recoveredPath.c_str());
+        if (!restored) {
+            std::cerr << "Point-in-time restore failed" << std::endl;
+            return false;
+        }
+        
+        if (walArchiver.createBaseSnapshot(true)) {
+            walArchiver.prune();
+        }
+        return true;
+    };
     
-    if (stmt && sqlite3_step(stmt) == SQLITE_ROW) {
-        ss << "Users: " << sqlite3_column_int(stmt, 0) << "\n";
+    // The WAL only holds materialized transfers, so the ledger catches up
+    // before the archive is taken
+    if (!(ledger ? ledger->rebase(restore) : restore())) {
+        return false;
     }
-    if (stmt) sqlite3_finalize(stmt);
     
-    // Count wallets
-    const char* walletCountSql = "SELECT COUNT(*) FROM wallets;";
-    stmt = sqlite3_prepare_v2(db, walletCountSql, -1, &stmt, nullptr) == SQLITE_OK ? stmt : nullptr;
-    if (stmt && sqlite3_step(stmt) == SQLITE_ROW) {
-        ss << "Wallets: " << sqlite3_column_int(stmt, 0) << "\n";
+    std::cout << "Database restored to point in time" << std::endl;
+    return true;
+}
+
+// ==================== UTILITY METHODS ====================
+
+bool DatabaseManager::isReady() const {
+    return db != nullptr;
+}
+
+bool DatabaseManager::optimize() {
+    std::lock_guard<std::mutex> lock(dbMutex);
+    if (!db) return false;
+    
+    // Analyzes only tables whose statistics are missing or out of date, so
+    // it is cheap enough to run periodically on a long-lived connection
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, "PRAGMA optimize;", nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "Optimize error: " << (errMsg ? errMsg : sqlite3_errmsg(db)) << std::endl;
+        sqlite3_free(errMsg);
+        return false;
     }
-    if (stmt) sqlite3_finalize(stmt);
+    return true;
+}
+
+void DatabaseManager::setPreferredIdFormat(IdFormat format) {
+    preferredIdFormat = format;
+}
+
+IdFormat DatabaseManager::getIdFormat() const {
+    return idFormat;
+}
+
+bool DatabaseManager::loadSystemStats(SystemStats& stats) const {
+    auto reader = readerPool.acquire();
+    if (!reader) return false;
     
-    // Count transactions
-    const char* txCountSql = "SELECT COUNT(*) FROM transactions;";
-    stmt = sqlite3_prepare_v2(db, txCountSql, -1, &stmt, nullptr) == SQLITE_OK ? stmt : nullptr;
-    if (stmt && sqlite3_step(stmt) == SQLITE_ROW) {
-        ss << "Transactions: " << sqlite3_column_int(stmt, 0) << "\n";
+    const char* sql = R"(
+        SELECT user_count, wallet_count, locked_wallets, transaction_count, total_points
+        FROM system_stats WHERE id = 1;
+    )";
+    sqlite3_stmt* stmt = reader.statements().acquire(StatementId::SYSTEM_STATS_SELECT, sql);
+    if (!stmt) return false;
+    
+    bool found = sqlite3_step(stmt) == SQLITE_ROW;
+    if (found) {
+        stats.users = sqlite3_column_int64(stmt, 0);
+        stats.wallets = sqlite3_column_int64(stmt, 1);
+        stats.lockedWallets = sqlite3_column_int64(stmt, 2);
+        stats.transactions = sqlite3_column_int64(stmt, 3);
+        stats.totalPoints = sqlite3_column_double(stmt, 4);
+    }
+    releaseStatement(stmt);
+    return found;
+}
+
+std::string DatabaseManager::getStatistics() const {
+    // A restore swaps the writer and reloads the ID format under dbMutex;
+    // both are copied and the lock dropped before anything else is taken
+    bool ready;
+    IdFormat format;
+    {
+        std::lock_guard<std::mutex> lock(dbMutex);
+        ready = db != nullptr;
+        format = idFormat;
     }
-    if (stmt) sqlite3_finalize(stmt);
+    if (!ready) return "Database not initialized";
     
+    std::stringstream ss;
+    SystemStats stats;
+    if (loadSystemStats(stats)) {
+        ss << "Users: " << stats.users << "\n";
+        ss << "Wallets: " << stats.wallets << " (" << stats.lockedWallets << " locked)\n";
+        ss << "Transactions: " << stats.transactions << "\n";
+        ss << "Total points: " << std::fixed << std::setprecision(2) << stats.totalPoints << "\n";
+        ss.unsetf(std::ios::floatfield);
+    }
+    
+    // Summing cache counters locks every reader, so no lease may be held here
+    ss << "Reader connections: " << readerPool.size() << "\n";
+    ss << "ID format: " << idFormatName(format) << "\n";
+    PageStore::Stats backupStore = pageStore.getStats();
+    ss << "Backup page store: " << backupStore.manifests << " backups, ";
+    if (backupStore.indexLoaded) {
+        ss << backupStore.uniquePages << " unique pages, ";
+    }
+    ss << backupStore.packBytes << " bytes\n";
+    {
+        std::lock_guard<std::mutex> lock(groupCommitMutex);
+        if (groupCommitWriter) {
+            ss << "Group commits: " << groupCommitWriter->getCommittedGroups() << " groups, "
+               << groupCommitWriter->getCommittedTransfers() << " transfers\n";
+        }
+    }
+    if (ledger) {
+        ss << "Ledger: " << ledger->getJournalSize() << " journaled transfers, applied through #"
+           << ledger->getAppliedSequence() << "\n";
+    }
+    ss << "Statement cache: " << getStatementCacheHits() << " hits, "
+       << getStatementCacheMisses() << " misses\n";
     ss << "Database: " << dbPath;
     return ss.str();
 }
+
+size_t DatabaseManager::getStatementCacheHits() const {
+    std::lock_guard<std::mutex> lock(dbMutex);
+    return statementCache.getHits() + readerPool.getStatementCacheHits();
+}
+
+size_t DatabaseManager::getStatementCacheMisses() const {
+    std::lock_guard<std::mutex> lock(dbMutex);
+    return statementCache.getMisses() + readerPool.getStatementCacheMisses();
+}
@@ -3,10 +3,25 @@
 
 #include "../models/User.h"
 #include "../models/Wallet.h"
+#include "StatementCache.h"
+#include "ReaderPool.h"
+#include "GroupCommitWriter.h"
+#include "IdColumns.h"
+#include "BackupJob.h"
+#include "BackupCatalog.h"
+#include "WalArchiver.h"
+#include "PageStore.h"
+#include "TransactionArchive.h"
+#include "StorageBackend.h"
+#include "TransferLedger.h"
+#include "TransactionExporter.h"
 #include <string>
 #include <vector>
 #include <memory>
 #include <chrono>
+#include <functional>
+#include <cstdint>
+#include <atomic>
 #include <sqlite3.h>
 
 #ifdef _WIN32
@@ -15,63 +30,157 @@
     #include <mutex>
 #endif
 
-enum class BackupType {
-    MANUAL,
-    AUTO,
-    EMERGENCY
-};
-
-struct BackupInfo {
-    std::string backupId;
-    std::string filename;
-    BackupType type;
-    std::chrono::system_clock::time_point timestamp;
-    size_t fileSize;
-    std::string checksum;
-};
-
-class DatabaseManager {
+class DatabaseManager : public StorageBackend {
 private:
     sqlite3* db;
     std::string dbPath;
     std::string backupDirectory;
     mutable std::mutex dbMutex;
-    std::vector<BackupInfo> backupHistory;
+    mutable StatementCache statementCache;
+    ReaderPool readerPool;
+    size_t readerCount;
+    std::unique_ptr<GroupCommitWriter> groupCommitWriter;
+    mutable std::mutex groupCommitMutex;
+    IdFormat idFormat;           // format of the open file, from schema_meta
+    IdFormat preferredIdFormat;  // used only when a new file is created
+    mutable BackupCatalog backupCatalog;  // loaded from its manifest on first use
+    // Guards backupCatalog and activeBackup; never held while waiting on a job
+    mutable std::mutex backupMutex;
+    std::shared_ptr<BackupJob> activeBackup;
+    std::string activeBackupId;  // its manifest may exist before its catalog entry
+    mutable PageStore pageStore;  // backups are kept as manifests over deduplicated pages
+    WalArchiver walArchiver;
+    // Serializes WAL archiving, base snapshots and restores; taken before dbMutex
+    std::mutex archiveMutex;
+    TransactionArchive transactionArchive;  // monthly cold partitions of old history
+    // Set while a maintenance thread calls checkpointWal(); commits then
+    // only wake it, and archive themselves past WAL_BACKSTOP_FRAMES
+    std::function<void()> walCheckpointDue;
+    std::atomic<int> walFrames;  // WAL frame count after the last commit
+    std::string ledgerPath;
+    bool ledgerMode;
+    // Set by initialize() in ledger mode; transfers then go to the journal
+    std::unique_ptr<TransferLedger> ledger;
     
     static const int MAX_BACKUP_COUNT = 10;
-    static const int AUTO_BACKUP_INTERVAL_HOURS = 24;
+    // Grandfather-father-son retention on top of the newest keepCount backups
+    static const int DAILY_BACKUPS_KEPT = 7;
+    static const int WEEKLY_BACKUPS_KEPT = 4;
+    static const int MONTHLY_BACKUPS_KEPT = 12;
+    static const size_t DEFAULT_READER_COUNT = 4;
+    static const size_t STREAM_CHUNK_SIZE = 256;
+    static const size_t INDEX_REBUILD_MIN_ACCOUNTS = 10000;
 
+    // Opens the connections and schema; initialize() then adds the ledger
+    bool openDatabase();
+    // Replays the journal past schema_meta's ledger_sequence and starts
+    // materializing; runs without dbMutex held
+    bool openLedger();
+    bool loadLedgerBalance(const std::string& walletId, double& balance);
+    // Applies journaled transfers and records the last sequence number in
+    // one transaction; an entry that no longer fits is logged and skipped
+    bool materializeLedgerEntries(const std::vector<LedgerEntry>& entries);
+    bool applyLedgerEntry(const LedgerEntry& entry);
     bool createTables();
+    bool tableExists(const char* tableName);
+    // Reads (or records, on first open) the ID format in schema_meta
+    bool loadIdFormat(bool isNewDatabase);
+    // Cancels the running backup (if any) and waits for it to stop
+    void cancelActiveBackup();
+    // Opens the writer connection with foreign keys and WAL mode enabled
+    bool openWriter();
     bool enableWALMode();
+    // WAL hook on the writer connection: records commit times and archives
+    // the WAL in place of SQLite's automatic checkpoint
+    static int onWalCommit(void* context, sqlite3* connection, const char* dbName, int walFrames);
+    // Swaps in another database file and reopens all connections; the
+    // caller holds archiveMutex and dbMutex. With consumeSource the file is
+    // moved rather than copied, so it must be on the database's filesystem.
+    bool replaceDatabaseFile(const std::string& sourcePath, bool consumeSource = false);
     
     sqlite3_stmt* prepareStatement(const std::string& sql);
     bool executeStatement(sqlite3_stmt* stmt);
     void finalizeStatement(sqlite3_stmt* stmt);
+    sqlite3_stmt* acquireStatement(StatementId id, const char* sql) const;
+    void releaseStatement(sqlite3_stmt* stmt) const;
     
     bool beginTransaction();
     bool commitTransaction();
     bool rollbackTransaction();
+    bool executeCachedStatement(StatementId id, const char* sql);
+    // Binds every column of USER_INSERT_SQL
+    void bindUserInsert(sqlite3_stmt* stmt, const User& user);
+    // Inserts one account inside the caller's open transaction; sets the
+    // message on failure
+    bool insertAccount(const NewAccount& account, std::string& message);
+    
+    // Applies one transfer inside the caller's open transaction
+    bool executeTransferLeg(const TransferRequest& request, TransferResult& result);
+    
+    // Hot rows only; wallets loaded into memory carry their recent history
+    std::vector<Transaction> loadWalletTransactions(StatementCache& statements,
+                                                    const std::string& walletId);
+    // Appends up to `limit` (negative: all) archived rows of the wallet that
+    // are older than both `cursor` and `watermark`, newest first
+    bool loadArchivedTransactions(const TransactionArchive::Partition& partition,
+                                  const std::string& walletId, const HistoryCursor& cursor,
+                                  int64_t watermark, int64_t limit,
+                                  std::vector<Transaction>& transactions);
+    // Reads the hot rows of a wallet and, if they run out before `limit`
+    // rows, continues into the archives; both come from one snapshot
+    std::vector<Transaction> loadHistory(const std::string& walletId, const HistoryCursor& cursor,
+                                         int64_t limit);
 
 public:
-    DatabaseManager(const std::string& dataDir = "data");
+    static const int AUTO_BACKUP_INTERVAL_HOURS = 24;
+    // Past this size checkpointWal() truncates the WAL instead of reusing it
+    static const int64_t WAL_SIZE_BUDGET_BYTES = 64LL * 1024 * 1024;
+    static const int WAL_BACKSTOP_FRAMES = 10 * WalArchiver::ARCHIVE_THRESHOLD_FRAMES;
+
+    DatabaseManager(const std::string& dataDir = "data",
+                    size_t readerCount = DEFAULT_READER_COUNT);
     ~DatabaseManager();
-    bool initialize();
+    bool initialize() override;
+    // Chooses how IDs are stored if initialize() creates a new database file
+    // (default BLOB). Existing files keep the format they were created with.
+    void setPreferredIdFormat(IdFormat format);
+    IdFormat getIdFormat() const;
+    // Ledger mode (call before initialize()): transfers are acknowledged
+    // once written to <dataDir>/ledger.journal and reach the wallets and
+    // transactions tables shortly afterwards
+    void setLedgerMode(bool enabled);
+    bool isLedgerMode() const;
+    // Waits until the database holds every transfer journaled so far;
+    // true at once without a ledger
+    bool flushLedger();
+
+    using StorageBackend::saveUser;
+    using StorageBackend::saveWallet;
 
-    bool saveUser(const User& user);
-    bool saveUser(std::shared_ptr<User> user);
+    bool saveUser(const User& user) override;
     std::unique_ptr<User> loadUser(const std::string& username);
-    std::unique_ptr<User> loadUserByUsername(const std::string& username);
-    std::unique_ptr<User> loadUserById(const std::string& userId);
+    std::unique_ptr<User> loadUserByUsername(const std::string& username) override;
+    std::unique_ptr<User> loadUserById(const std::string& userId) override;
 
-    std::vector<std::shared_ptr<User>> loadAllUsers();
+    // Streams rows in keyset order, STREAM_CHUNK_SIZE at a time. The reader
+    // lease is released before the visitor sees a chunk, so visitors may call
+    // back into the DatabaseManager. Return false from the visitor to stop.
+    // Both return the number of rows visited.
+    size_t forEachUser(const UserVisitor& visitor, unsigned columns = USER_COLUMNS_ALL) override;
+    size_t forEachWallet(const WalletVisitor& visitor) override;
+
+    std::vector<std::shared_ptr<User>> loadAllUsers() override;
     bool updateUser(const User& user);
-    bool deleteUser(const std::string& userId);
+    bool deleteUser(const std::string& userId) override;
+    // Savepoint per account inside transactions of the whole list. Lists of
+    // at least INDEX_REBUILD_MIN_ACCOUNTS that also outnumber the existing
+    // wallets drop the secondary indexes and rebuild them before commit.
+    std::vector<std::string> importAccounts(const std::vector<NewAccount>& accounts) override;
 
-    bool saveWallet(const Wallet& wallet);
-    bool saveWallet(std::shared_ptr<Wallet> wallet);
-    std::shared_ptr<Wallet> loadWallet(const std::string& walletId);
+    bool saveWallet(const Wallet& wallet) override;
+    std::shared_ptr<Wallet> loadWallet(const std::string& walletId) override;
 
-    std::shared_ptr<Wallet> loadWalletByOwnerId(const std::string& ownerId);
+    std::shared_ptr<Wallet> loadWalletByOwnerId(const std::string& ownerId) override;
     std::vector<std::shared_ptr<Wallet>> loadAllWallets();
     bool updateWallet(const Wallet& wallet);
 
@@ -82,18 +191,84 @@ public:
     std::string transferPointsWithId(const std::string& fromWalletId, 
                                     const std::string& toWalletId, 
                                     double amount, 
-                                    const std::string& description);
+                                    const std::string& description) override;
+    // Applies all transfers in one transaction; failing legs are rolled
+    // back individually through savepoints and reported in their result
+    std::vector<TransferResult> transferPointsBatch(const std::vector<TransferRequest>& requests) override;
+    // Queues a transfer for the group-commit writer thread; the future
+    // completes when the group containing it has committed
+    std::future<TransferResult> submitTransfer(const TransferRequest& request,
+                                               TransferCallback onCommitted = nullptr) override;
 
-    std::string getMasterWalletId();
-    bool saveTransaction(const Transaction& transaction);
+    std::string getMasterWalletId() override;
+    bool saveTransaction(const Transaction& transaction) override;
+    // Full history, archived transactions included, newest first
     std::vector<Transaction> loadWalletTransactions(const std::string& walletId);
+    // Returns up to pageSize transactions older than `cursor`, newest first;
+    // archives in <dataDir>/archive are only opened once the hot rows run out
+    TransactionPage loadTransactionPage(const std::string& walletId,
+                                        const HistoryCursor& cursor = HistoryCursor(),
+                                        size_t pageSize = DEFAULT_HISTORY_PAGE_SIZE) override;
+    WalletFlowSummary loadWalletFlowSummary(const std::string& walletId) override;
+    // Moves transactions older than hotDays into the monthly archives, one
+    // month per write lock; returns the number of rows moved, or -1
+    int archiveOldTransactions(int hotDays = TransactionArchive::DEFAULT_HOT_DAYS);
+    // Days of history the maintenance scheduler keeps in the main file
+    // before archiving older transactions; 0, the default, leaves automatic
+    // archiving off. Stored in schema_meta, so it travels with the file
+    int getArchiveHotDays();
+    bool setArchiveHotDays(int days);
+    // Streams the matching transactions to a file, archived months first
+    // (oldest first) then the hot table, all from one reader snapshot;
+    // returns the number of rows written, or -1
+    int64_t exportTransactions(const std::string& path, ExportFormat format,
+                               const TransactionExportFilter& filter = TransactionExportFilter());
+
+    // OTP persistence on the writer connection; times are seconds since epoch
+    bool saveOTP(const std::string& userId, const std::string& purpose,
+                 const std::string& otpCode, int64_t expiresAt) override;
+    std::string loadOTP(const std::string& userId, const std::string& purpose, int64_t now) override;
+    // Deletes the OTP only if the code matches and has not expired
+    bool consumeOTP(const std::string& userId, const std::string& purpose,
+                    const std::string& otpCode, int64_t now) override;
+    void removeOTP(const std::string& userId, const std::string& purpose) override;
+    int removeExpiredOTPs(int64_t now) override;
 
+    // Starts an online backup on a background thread without blocking
+    // writers; returns nullptr if another backup is still running
+    std::shared_ptr<BackupJob> startBackup(const std::string& description = "",
+                                           BackupType type = BackupType::MANUAL);
+    std::shared_ptr<BackupJob> getActiveBackup() const;
+    // startBackup() followed by waiting for the job to finish
     bool createBackup(const std::string& description = "", BackupType type = BackupType::MANUAL);
     bool restoreFromBackup(const std::string& backupId);
     std::vector<BackupInfo> getBackupHistory() const;
+    // Keeps the newest keepCount backups plus the newest one of each recent
+    // day, week and month, then drops pages no remaining backup uses
     int cleanupOldBackups(int keepCount = MAX_BACKUP_COUNT);
+
+    // Point-in-time recovery from the WAL archive in <dataDir>/backup/wal
+    bool archiveWal();
+    // Archives and checkpoints the WAL if it is due, truncating it once it
+    // exceeds WAL_SIZE_BUDGET_BYTES; meant for a background thread
+    bool checkpointWal();
+    // Hands WAL checkpoints to a background thread: commits call `notify`
+    // (quickly, under the write lock) once a checkpoint is due instead of
+    // running it. Pass nullptr to checkpoint on commit again.
+    void setBackgroundCheckpoints(std::function<void()> notify);
+    // Takes a new base snapshot if the segments since the last one have
+    // outgrown the database (or force is set)
+    bool createBaseSnapshot(bool force = false);
+    std::chrono::system_clock::time_point getEarliestRecoveryPoint();
+    bool restoreToPointInTime(const std::chrono::system_clock::time_point& target);
     bool isReady() const;
+    // PRAGMA optimize: refreshes planner statistics (ANALYZE) where stale
+    bool optimize();
     std::string getStatistics() const;
+    // Reads the trigger-maintained counters; O(1) regardless of data size
+    bool loadSystemStats(SystemStats& stats) const override;
+    size_t getStatementCacheHits() const;
+    size_t getStatementCacheMisses() const;
 };
 
 #endif
@@ -0,0 +1,98 @@
+#include "FileChecksum.h"
+#include "../security/picosha2.h"
+#include <fstream>
+#include <vector>
+#include <array>
+#include <future>
+#include <thread>
+
+typedef std::array<unsigned char, picosha2::k_digest_size> Digest;
+
+// Reads up to `count` chunks into `batch`; returns the number of chunks filled
+static size_t readBatch(std::ifstream& file, std::vector<std::vector<unsigned char>>& batch,
+                        size_t count, uint64_t& totalSize) {
+    size_t filled = 0;
+    while (filled < count && file) {
+        std::vector<unsigned char>& chunk = batch[filled];
+        chunk.resize(FileChecksum::CHUNK_SIZE);
+        file.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+        std::streamsize got = file.gcount();
+        if (got <= 0) break;
+        chunk.resize(static_cast<size_t>(got));
+        totalSize += static_cast<uint64_t>(got);
+        ++filled;
+    }
+    return filled;
+}
+
+// Hashes the first `count` chunks of `batch` in parallel, one task per chunk
+static std::vector<std::future<Digest>> hashBatch(const std::vector<std::vector<unsigned char>>& batch,
+                                                 size_t count) {
+    std::vector<std::future<Digest>> pending;
+    pending.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const std::vector<unsigned char>* chunk = &batch[i];
+        pending.push_back(std::async(std::launch::async, [chunk]() {
+            Digest digest;
+            picosha2::hash256(chunk->begin(), chunk->end(), digest.begin(), digest.end());
+            return digest;
+        }));
+    }
+    return pending;
+}
+
+FileDigest FileChecksum::compute(const std::string& path, unsigned threads) {
+    FileDigest result;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return result;
+
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 2;
+    }
+
+    // Double buffering: one batch is hashed while the next one is read
+    std::vector<std::vector<unsigned char>> reading(threads), hashing(threads);
+    std::vector<unsigned char> digests;
+    uint64_t totalSize = 0;
+
+    size_t count = readBatch(file, reading, threads, totalSize);
+    while (count > 0) {
+        reading.swap(hashing);
+        auto pending = hashBatch(hashing, count);
+        size_t nextCount = readBatch(file, reading, threads, totalSize);
+
+        for (auto& digest : pending) {
+            Digest value = digest.get();
+            digests.insert(digests.end(), value.begin(), value.end());
+        }
+        count = nextCount;
+    }
+
+    if (file.bad()) return result;
+
+    // Root = SHA-256(size as 8 little-endian bytes || chunk digests)
+    std::vector<unsigned char> root;
+    root.reserve(8 + digests.size());
+    for (int i = 0; i < 8; ++i) {
+        root.push_back(static_cast<unsigned char>((totalSize >> (8 * i)) & 0xFF));
+    }
+    root.insert(root.end(), digests.begin(), digests.end());
+
+    result.ok = true;
+    result.size = totalSize;
+    result.checksum = "sha256t:" + picosha2::hash256_hex_string(root);
+    return result;
+}
+
+bool FileChecksum::verify(const std::string& path, uint64_t expectedSize,
+                          const std::string& expectedChecksum, unsigned threads) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    if (static_cast<uint64_t>(file.tellg()) != expectedSize) return false;
+    file.close();
+
+    FileDigest digest = compute(path, threads);
+    return digest.ok && digest.size == expectedSize && digest.checksum == expectedChecksum;
+}
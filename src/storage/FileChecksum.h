@@ -0,0 +1,33 @@
+#ifndef FILE_CHECKSUM_H
+#define FILE_CHECKSUM_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// Size and checksum of a file, computed in one streaming pass.
+// The checksum is a two-level SHA-256 tree: the file is split into
+// CHUNK_SIZE chunks that are hashed in parallel, and the result is the
+// SHA-256 of the file size followed by all chunk digests. It is written as
+// "sha256t:<hex>" so it is never confused with a plain SHA-256 of the file.
+// At most two batches of chunks (one being read, one being hashed) are in
+// memory at any time, regardless of the file size.
+struct FileDigest {
+    bool ok = false;
+    uint64_t size = 0;
+    std::string checksum;
+};
+
+class FileChecksum {
+public:
+    static const size_t CHUNK_SIZE = 4 * 1024 * 1024;
+
+    // threads == 0 uses std::thread::hardware_concurrency()
+    static FileDigest compute(const std::string& path, unsigned threads = 0);
+
+    // Cheap size check first, then a full recomputation
+    static bool verify(const std::string& path, uint64_t expectedSize,
+                       const std::string& expectedChecksum, unsigned threads = 0);
+};
+
+#endif
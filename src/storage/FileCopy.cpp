@@ -0,0 +1,112 @@
+#include "FileCopy.h"
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+    #include <sys/stat.h>
+#endif
+#ifdef __linux__
+    #include <sys/ioctl.h>
+    #include <linux/fs.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static bool streamCopy(const std::string& from, const std::string& to) {
+    std::ifstream src(from, std::ios::binary);
+    std::ofstream dst(to, std::ios::binary | std::ios::trunc);
+    if (!src || !dst) return false;
+
+    std::vector<char> buffer(1 << 20);
+    while (src.read(buffer.data(), buffer.size()) || src.gcount() > 0) {
+        if (!dst.write(buffer.data(), src.gcount())) return false;
+    }
+    return src.eof() && static_cast<bool>(dst.flush());
+}
+
+#ifdef __linux__
+// Returns 1 when copied, 0 when the kernel cannot do it for these files
+// (so a fallback applies), and -1 on a real error
+static int kernelCopy(int in, int out, off_t size) {
+#ifdef FICLONE
+    if (ioctl(out, FICLONE, in) == 0) {
+        return 1;
+    }
+#endif
+
+    off_t copied = 0;
+    while (copied < size) {
+        ssize_t n = copy_file_range(in, nullptr, out, nullptr, static_cast<size_t>(size - copied), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            bool unsupported = errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP || errno == EINVAL;
+            return copied == 0 && unsupported ? 0 : -1;
+        }
+        if (n == 0) break;   // source shrank underneath us
+        copied += n;
+    }
+    return copied == size ? 1 : -1;
+}
+#endif
+
+bool FileCopy::copy(const std::string& from, const std::string& to) {
+#ifdef __linux__
+    int in = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return false;
+
+    struct stat st;
+    int out = fstat(in, &st) == 0
+        ? open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)
+        : -1;
+    if (out < 0) {
+        close(in);
+        return false;
+    }
+
+    int result = kernelCopy(in, out, st.st_size);
+    close(out);
+    close(in);
+    if (result != 0) {
+        return result > 0;
+    }
+#endif
+    return streamCopy(from, to);
+}
+
+bool FileCopy::sync(const std::string& path) {
+#ifdef _WIN32
+    int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0) return false;
+    bool ok = _commit(fd) == 0;
+    _close(fd);
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+#endif
+    return ok;
+}
+
+bool FileCopy::replace(const std::string& from, const std::string& to) {
+    // std::filesystem::rename replaces an existing target on every
+    // platform (MoveFileEx on Windows), unlike std::rename
+    std::error_code ec;
+    fs::rename(from, to, ec);
+    if (ec) return false;
+
+#ifndef _WIN32
+    std::string directory = fs::path(to).parent_path().string();
+    int fd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+#endif
+    return true;
+}
@@ -0,0 +1,24 @@
+#ifndef FILE_COPY_H
+#define FILE_COPY_H
+
+#include <string>
+
+// Whole-file copies and durable replacement for backup and restore.
+// On Linux copy() first tries a reflink (FICLONE), which shares extents on
+// copy-on-write filesystems, then copy_file_range(), which keeps the data
+// in the kernel; elsewhere, or when neither applies, it streams through a
+// buffer. None of these make the copy durable: call sync() before relying
+// on it, and replace() to move it into place.
+class FileCopy {
+public:
+    static bool copy(const std::string& from, const std::string& to);
+
+    // Flushes the file's data to disk
+    static bool sync(const std::string& path);
+
+    // Renames `from` over `to` in one step, so a crash leaves one or the
+    // other, then syncs the directory so the rename itself is durable
+    static bool replace(const std::string& from, const std::string& to);
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "GroupCommitWriter.h"
+#include <iostream>
+
+GroupCommitWriter::GroupCommitWriter(BatchExecutor executor,
+                                     size_t maxGroupSize,
+                                     std::chrono::microseconds maxDelay)
+    : executor(executor),
+      maxGroupSize(maxGroupSize > 0 ? maxGroupSize : 1),
+      maxDelay(maxDelay),
+      stopping(false),
+      committedGroups(0),
+      committedTransfers(0) {
+    worker = std::thread(&GroupCommitWriter::run, this);
+}
+
+GroupCommitWriter::~GroupCommitWriter() {
+    stop();
+}
+
+std::future<TransferResult> GroupCommitWriter::submit(const TransferRequest& request,
+                                                      CommitCallback onCommitted) {
+    PendingTransfer pending;
+    pending.request = request;
+    pending.onCommitted = onCommitted;
+    std::future<TransferResult> future = pending.promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (stopping) {
+            pending.promise.set_value(TransferResult{false, "Writer is shutting down", "", 0.0});
+            return future;
+        }
+        queue.push_back(std::move(pending));
+    }
+    queueReady.notify_one();
+
+    return future;
+}
+
+void GroupCommitWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_one();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void GroupCommitWriter::run() {
+    std::vector<PendingTransfer> group;
+    group.reserve(maxGroupSize);
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this] { return stopping || !queue.empty(); });
+
+            if (queue.empty()) {
+                return; // stopping and fully drained
+            }
+
+            // The group opens with its first request; keep collecting until
+            // it is full or the delay budget is spent
+            auto deadline = std::chrono::steady_clock::now() + maxDelay;
+            queueReady.wait_until(lock, deadline, [this] {
+                return stopping || queue.size() >= maxGroupSize;
+            });
+
+            while (!queue.empty() && group.size() < maxGroupSize) {
+                group.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+
+        commitGroup(group);
+        group.clear();
+    }
+}
+
+void GroupCommitWriter::commitGroup(std::vector<PendingTransfer>& group) {
+    std::vector<TransferRequest> requests;
+    requests.reserve(group.size());
+    for (const auto& pending : group) {
+        requests.push_back(pending.request);
+    }
+
+    std::vector<TransferResult> results;
+    try {
+        results = executor(requests);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[ERROR] Group commit failed: " << e.what() << std::endl;
+    }
+
+    if (results.size() != group.size()) {
+        results.assign(group.size(), TransferResult{false, "Group commit failed", "", 0.0});
+    }
+
+    committedGroups++;
+    committedTransfers += group.size();
+
+    for (size_t i = 0; i < group.size(); ++i) {
+        if (group[i].onCommitted) {
+            try {
+                group[i].onCommitted(results[i]);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "[ERROR] Commit callback failed: " << e.what() << std::endl;
+            }
+        }
+        group[i].promise.set_value(results[i]);
+    }
+}
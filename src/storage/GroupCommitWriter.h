@@ -0,0 +1,70 @@
+#ifndef GROUP_COMMIT_WRITER_H
+#define GROUP_COMMIT_WRITER_H
+
+#include "../models/Wallet.h"
+#include <vector>
+#include <deque>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+
+// Dedicated writer thread that commits queued transfers in groups.
+// A group is closed when it reaches maxGroupSize requests or when maxDelay
+// has passed since its first request, whichever comes first. Each caller's
+// future completes once the group containing its transfer has committed.
+class GroupCommitWriter {
+public:
+    using BatchExecutor = std::function<std::vector<TransferResult>(const std::vector<TransferRequest>&)>;
+    using CommitCallback = std::function<void(const TransferResult&)>;
+
+private:
+    struct PendingTransfer {
+        TransferRequest request;
+        CommitCallback onCommitted;
+        std::promise<TransferResult> promise;
+    };
+
+    BatchExecutor executor;
+    size_t maxGroupSize;
+    std::chrono::microseconds maxDelay;
+
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<PendingTransfer> queue;
+    bool stopping;
+    std::thread worker;
+
+    std::atomic<size_t> committedGroups;
+    std::atomic<size_t> committedTransfers;
+
+    void run();
+    void commitGroup(std::vector<PendingTransfer>& group);
+
+public:
+    static const size_t DEFAULT_MAX_GROUP_SIZE = 256;
+
+    GroupCommitWriter(BatchExecutor executor,
+                      size_t maxGroupSize = DEFAULT_MAX_GROUP_SIZE,
+                      std::chrono::microseconds maxDelay = std::chrono::milliseconds(2));
+    ~GroupCommitWriter();
+
+    GroupCommitWriter(const GroupCommitWriter&) = delete;
+    GroupCommitWriter& operator=(const GroupCommitWriter&) = delete;
+
+    // Queues a transfer; onCommitted (optional) runs on the writer thread
+    // before the future is fulfilled
+    std::future<TransferResult> submit(const TransferRequest& request,
+                                       CommitCallback onCommitted = nullptr);
+
+    // Commits everything still queued, then joins the writer thread
+    void stop();
+
+    size_t getCommittedGroups() const { return committedGroups.load(); }
+    size_t getCommittedTransfers() const { return committedTransfers.load(); }
+};
+
+#endif
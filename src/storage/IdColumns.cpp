@@ -0,0 +1,36 @@
+#include "IdColumns.h"
+#include "../models/Uuid.h"
+
+const char* idFormatName(IdFormat format) {
+    return format == IdFormat::BLOB ? "blob" : "text";
+}
+
+bool parseIdFormat(const std::string& name, IdFormat& out) {
+    if (name == "text") {
+        out = IdFormat::TEXT;
+        return true;
+    }
+    if (name == "blob") {
+        out = IdFormat::BLOB;
+        return true;
+    }
+    return false;
+}
+
+void bindId(sqlite3_stmt* stmt, int index, const std::string& id, IdFormat format) {
+    Uuid uuid;
+    if (format == IdFormat::BLOB && Uuid::parse(id, uuid)) {
+        sqlite3_bind_blob(stmt, index, uuid.data(), static_cast<int>(Uuid::SIZE), SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_text(stmt, index, id.c_str(), -1, SQLITE_TRANSIENT);
+    }
+}
+
+std::string columnId(sqlite3_stmt* stmt, int column) {
+    if (sqlite3_column_type(stmt, column) == SQLITE_BLOB &&
+        sqlite3_column_bytes(stmt, column) == static_cast<int>(Uuid::SIZE)) {
+        return Uuid(static_cast<const uint8_t*>(sqlite3_column_blob(stmt, column))).toString();
+    }
+    const unsigned char* text = sqlite3_column_text(stmt, column);
+    return text ? std::string(reinterpret_cast<const char*>(text)) : std::string();
+}
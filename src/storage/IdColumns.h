@@ -0,0 +1,24 @@
+#ifndef ID_COLUMNS_H
+#define ID_COLUMNS_H
+
+#include <string>
+#include <sqlite3.h>
+
+// How ID columns (user_id, wallet_id, transaction_id, ...) are stored.
+// The format is chosen when a database file is created and recorded in its
+// schema_meta table; existing files keep the format they were created with.
+enum class IdFormat {
+    TEXT,   // 36-character UUID strings (original layout)
+    BLOB    // 16-byte binary UUIDs; non-UUID IDs such as "SYSTEM" stay TEXT
+};
+
+const char* idFormatName(IdFormat format);
+bool parseIdFormat(const std::string& name, IdFormat& out);
+
+// Binds an ID in the database's storage format
+void bindId(sqlite3_stmt* stmt, int index, const std::string& id, IdFormat format);
+
+// Reads an ID column back as its string form, whichever way it was stored
+std::string columnId(sqlite3_stmt* stmt, int column);
+
+#endif
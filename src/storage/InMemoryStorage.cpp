@@ -0,0 +1,487 @@
+#include "InMemoryStorage.h"
+#include "../security/SecurityUtils.h"
+#include <limits>
+
+InMemoryStorage::InMemoryStorage() : nextUserSequence(0) {
+}
+
+bool InMemoryStorage::initialize() {
+    return true;
+}
+
+int64_t InMemoryStorage::toSeconds(const std::chrono::system_clock::time_point& time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+}
+
+Wallet InMemoryStorage::makeWallet(const std::string& walletId, const StoredWallet& stored) {
+    Wallet wallet(walletId, stored.ownerId, stored.balance);
+    wallet.setLocked(stored.isLocked);
+    return wallet;
+}
+
+// ==================== USER MANAGEMENT ====================
+
+bool InMemoryStorage::saveUser(const User& user) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto byName = userIdsByUsername.find(user.getUsername());
+    if (byName != userIdsByUsername.end() && byName->second != user.getUserId()) {
+        return false;  // username taken by another user
+    }
+
+    auto it = users.find(user.getUserId());
+    if (it == users.end()) {
+        users.emplace(user.getUserId(), StoredUser{user, nextUserSequence++});
+        ++stats.users;
+    } else {
+        if (it->second.user.getUsername() != user.getUsername()) {
+            userIdsByUsername.erase(it->second.user.getUsername());
+        }
+        it->second.user = user;
+    }
+    userIdsByUsername[user.getUsername()] = user.getUserId();
+    return true;
+}
+
+std::unique_ptr<User> InMemoryStorage::loadUserByUsername(const std::string& username) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto byName = userIdsByUsername.find(username);
+    if (byName == userIdsByUsername.end()) return nullptr;
+    return std::make_unique<User>(users.at(byName->second).user);
+}
+
+std::unique_ptr<User> InMemoryStorage::loadUserById(const std::string& userId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = users.find(userId);
+    if (it == users.end()) return nullptr;
+    return std::make_unique<User>(it->second.user);
+}
+
+size_t InMemoryStorage::forEachUser(const UserVisitor& visitor, unsigned columns) {
+    (void)columns;
+
+    // Copied under the lock and visited without it, so visitors may call back in
+    std::vector<User> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot.reserve(users.size());
+        for (const auto& entry : users) {
+            snapshot.push_back(entry.second.user);
+        }
+    }
+
+    size_t visited = 0;
+    for (const auto& user : snapshot) {
+        ++visited;
+        if (!visitor(user)) break;
+    }
+    return visited;
+}
+
+std::vector<std::shared_ptr<User>> InMemoryStorage::loadAllUsers() {
+    std::vector<std::shared_ptr<User>> result;
+    forEachUser([&result](const User& user) {
+        result.push_back(std::make_shared<User>(user));
+        return true;
+    });
+    return result;
+}
+
+bool InMemoryStorage::deleteUser(const std::string& userId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = users.find(userId);
+    if (it == users.end()) return true;  // deleting nothing is not an error
+
+    // Wallets go with their owner, but not while transactions refer to them
+    auto owned = walletIdsByOwner.equal_range(userId);
+    for (auto entry = owned.first; entry != owned.second; ++entry) {
+        auto walletHistory = history.find(entry->second);
+        if (walletHistory != history.end() && !walletHistory->second.empty()) {
+            return false;
+        }
+    }
+
+    for (auto entry = owned.first; entry != owned.second; ++entry) {
+        auto wallet = wallets.find(entry->second);
+        if (wallet == wallets.end()) continue;
+        --stats.wallets;
+        if (wallet->second.isLocked) --stats.lockedWallets;
+        stats.totalPoints -= wallet->second.balance;
+        history.erase(entry->second);
+        aggregates.erase(entry->second);
+        wallets.erase(wallet);
+    }
+    walletIdsByOwner.erase(userId);
+    otps.erase(userId);
+
+    userIdsByUsername.erase(it->second.user.getUsername());
+    users.erase(it);
+    --stats.users;
+    return true;
+}
+
+// ==================== WALLET MANAGEMENT ====================
+
+std::vector<std::string> InMemoryStorage::importAccounts(const std::vector<NewAccount>& accounts) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<std::string> messages(accounts.size());
+    for (size_t i = 0; i < accounts.size(); ++i) {
+        const User& user = accounts[i].user;
+        if (userIdsByUsername.count(user.getUsername()) || users.count(user.getUserId())) {
+            messages[i] = "Username already exists";
+            continue;
+        }
+        if (wallets.count(user.getWalletId())) {
+            messages[i] = "Cannot create wallet: wallet ID already exists";
+            continue;
+        }
+
+        users.emplace(user.getUserId(), StoredUser{user, nextUserSequence++});
+        userIdsByUsername[user.getUsername()] = user.getUserId();
+        wallets.emplace(user.getWalletId(), StoredWallet{user.getUserId(), accounts[i].initialBalance, false});
+        walletIdsByOwner.emplace(user.getUserId(), user.getWalletId());
+        ++stats.users;
+        ++stats.wallets;
+        stats.totalPoints += accounts[i].initialBalance;
+    }
+    return messages;
+}
+
+bool InMemoryStorage::saveWallet(const Wallet& wallet) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (users.find(wallet.getOwnerId()) == users.end()) {
+        return false;  // owner must exist
+    }
+
+    // History lives in `transactions`; only the row is kept
+    StoredWallet stored{wallet.getOwnerId(), wallet.getBalance(), wallet.getIsLocked()};
+
+    auto it = wallets.find(wallet.getWalletId());
+    if (it == wallets.end()) {
+        ++stats.wallets;
+        walletIdsByOwner.emplace(wallet.getOwnerId(), wallet.getWalletId());
+        wallets.emplace(wallet.getWalletId(), stored);
+    } else {
+        StoredWallet& previous = it->second;
+        stats.totalPoints -= previous.balance;
+        if (previous.isLocked) --stats.lockedWallets;
+
+        if (previous.ownerId != wallet.getOwnerId()) {
+            auto owned = walletIdsByOwner.equal_range(previous.ownerId);
+            for (auto entry = owned.first; entry != owned.second; ++entry) {
+                if (entry->second == wallet.getWalletId()) {
+                    walletIdsByOwner.erase(entry);
+                    break;
+                }
+            }
+            walletIdsByOwner.emplace(wallet.getOwnerId(), wallet.getWalletId());
+        }
+        previous = stored;
+    }
+
+    stats.totalPoints += wallet.getBalance();
+    if (wallet.getIsLocked()) ++stats.lockedWallets;
+    return true;
+}
+
+std::shared_ptr<Wallet> InMemoryStorage::loadWallet(const std::string& walletId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = wallets.find(walletId);
+    if (it == wallets.end()) return nullptr;
+
+    auto wallet = std::make_shared<Wallet>(makeWallet(walletId, it->second));
+    for (const auto& transaction : loadHistory(walletId, HistoryCursor(),
+                                               std::numeric_limits<size_t>::max())) {
+        wallet->addTransaction(transaction);
+    }
+    return wallet;
+}
+
+std::shared_ptr<Wallet> InMemoryStorage::loadWalletByOwnerId(const std::string& ownerId) {
+    std::string walletId;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto owned = walletIdsByOwner.find(ownerId);
+        if (owned == walletIdsByOwner.end()) return nullptr;
+        walletId = owned->second;
+    }
+    return loadWallet(walletId);
+}
+
+size_t InMemoryStorage::forEachWallet(const WalletVisitor& visitor) {
+    std::vector<Wallet> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot.reserve(wallets.size());
+        for (const auto& entry : wallets) {
+            snapshot.push_back(makeWallet(entry.first, entry.second));
+        }
+    }
+
+    size_t visited = 0;
+    for (const auto& wallet : snapshot) {
+        ++visited;
+        if (!visitor(wallet)) break;
+    }
+    return visited;
+}
+
+// ==================== TRANSFERS ====================
+
+bool InMemoryStorage::executeTransferLeg(const TransferRequest& request, TransferResult& result) {
+    result.success = false;
+
+    if (request.amount <= 0) {
+        result.message = "Amount must be positive";
+        return false;
+    }
+
+    auto from = wallets.find(request.fromWalletId);
+    if (from == wallets.end()) {
+        result.message = "Source wallet not found";
+        return false;
+    }
+    if (from->second.balance < request.amount) {
+        result.message = "Insufficient balance";
+        return false;
+    }
+    auto to = wallets.find(request.toWalletId);
+    if (to == wallets.end()) {
+        result.message = "Destination wallet not found";
+        return false;
+    }
+
+    // Every check is done before anything changes, so a failing leg needs
+    // no rollback. Like the SQL path this does not look at is_locked.
+    double fromBalance = from->second.balance;
+    from->second.balance -= request.amount;
+    to->second.balance += request.amount;
+
+    Transaction transaction(SecurityUtils::generateUUID(), request.fromWalletId, request.toWalletId,
+                            request.amount, TransactionType::TRANSFER,
+                            TransactionStatus::COMPLETED, request.description);
+    recordTransaction(transaction);
+
+    result.success = true;
+    result.message = "Transfer completed";
+    result.transactionId = transaction.getId();
+    result.newBalance = fromBalance - request.amount;
+    return true;
+}
+
+std::string InMemoryStorage::transferPointsWithId(const std::string& fromWalletId,
+                                                  const std::string& toWalletId,
+                                                  double amount,
+                                                  const std::string& description) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    TransferRequest request{fromWalletId, toWalletId, amount, description, ""};
+    TransferResult result;
+    return executeTransferLeg(request, result) ? result.transactionId : "";
+}
+
+std::vector<TransferResult> InMemoryStorage::transferPointsBatch(const std::vector<TransferRequest>& requests) {
+    std::vector<TransferResult> results(requests.size(), TransferResult{false, "", "", 0.0});
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < requests.size(); ++i) {
+        executeTransferLeg(requests[i], results[i]);
+    }
+    return results;
+}
+
+std::future<TransferResult> InMemoryStorage::submitTransfer(const TransferRequest& request,
+                                                            TransferCallback onCommitted) {
+    TransferResult result{false, "", "", 0.0};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        executeTransferLeg(request, result);
+    }
+
+    // Outside the lock, as the callback may read the store
+    if (onCommitted) {
+        onCommitted(result);
+    }
+
+    std::promise<TransferResult> promise;
+    promise.set_value(result);
+    return promise.get_future();
+}
+
+// ==================== TRANSACTION MANAGEMENT ====================
+
+void InMemoryStorage::recordTransaction(const Transaction& transaction) {
+    size_t position = transactions.size();
+    transactions.push_back(transaction);
+    transactionIndex.emplace(transaction.getId(), position);
+
+    HistoryKey key{toSeconds(transaction.getTimestamp()), transaction.getId()};
+    history[transaction.getToWalletId()].emplace(key, position);
+
+    // A self-transfer is listed once and counts as inflow only
+    WalletFlowSummary& inflow = aggregates[transaction.getToWalletId()];
+    inflow.totalIn += transaction.getAmount();
+    ++inflow.countIn;
+    if (transaction.getFromWalletId() != transaction.getToWalletId()) {
+        history[transaction.getFromWalletId()].emplace(key, position);
+        WalletFlowSummary& outflow = aggregates[transaction.getFromWalletId()];
+        outflow.totalOut += transaction.getAmount();
+        ++outflow.countOut;
+    }
+
+    ++stats.transactions;
+}
+
+bool InMemoryStorage::saveTransaction(const Transaction& transaction) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (transactionIndex.count(transaction.getId()) > 0) {
+        return false;  // IDs are unique
+    }
+    if (wallets.find(transaction.getFromWalletId()) == wallets.end() ||
+        wallets.find(transaction.getToWalletId()) == wallets.end()) {
+        return false;
+    }
+
+    recordTransaction(transaction);
+    return true;
+}
+
+std::string InMemoryStorage::getMasterWalletId() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const StoredUser* first = nullptr;
+    for (const auto& entry : users) {
+        const StoredUser& candidate = entry.second;
+        if (candidate.user.getIsFirstLogin() && (!first || candidate.sequence < first->sequence)) {
+            first = &candidate;
+        }
+    }
+    return first ? first->user.getWalletId() : "";
+}
+
+std::vector<Transaction> InMemoryStorage::loadHistory(const std::string& walletId,
+                                                      const HistoryCursor& cursor,
+                                                      size_t limit) const {
+    std::vector<Transaction> result;
+
+    auto walletHistory = history.find(walletId);
+    if (walletHistory == history.end()) return result;
+
+    // Keys are ordered newest first, so everything past the cursor is older
+    const HistoryIndex& index = walletHistory->second;
+    for (auto it = index.upper_bound(HistoryKey{cursor.timestamp, cursor.transactionId});
+         it != index.end() && result.size() < limit; ++it) {
+        result.push_back(transactions[it->second]);
+    }
+    return result;
+}
+
+TransactionPage InMemoryStorage::loadTransactionPage(const std::string& walletId,
+                                                     const HistoryCursor& cursor,
+                                                     size_t pageSize) {
+    TransactionPage page;
+    if (pageSize == 0) return page;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // One extra row tells whether another page follows
+        page.transactions = loadHistory(walletId, cursor, pageSize + 1);
+    }
+    if (page.transactions.size() > pageSize) {
+        page.hasMore = true;
+        page.transactions.resize(pageSize);
+    }
+
+    if (!page.transactions.empty()) {
+        const Transaction& last = page.transactions.back();
+        page.nextCursor.timestamp = toSeconds(last.getTimestamp());
+        page.nextCursor.transactionId = last.getId();
+    } else {
+        page.nextCursor = cursor;
+    }
+    return page;
+}
+
+WalletFlowSummary InMemoryStorage::loadWalletFlowSummary(const std::string& walletId) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = aggregates.find(walletId);
+    return it != aggregates.end() ? it->second : WalletFlowSummary();
+}
+
+bool InMemoryStorage::loadSystemStats(SystemStats& result) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    result = stats;
+    return true;
+}
+
+// ==================== OTP MANAGEMENT ====================
+
+bool InMemoryStorage::saveOTP(const std::string& userId, const std::string& purpose,
+                              const std::string& otpCode, int64_t expiresAt) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (users.find(userId) == users.end()) {
+        return false;
+    }
+    otps[userId][purpose] = StoredOtp{otpCode, expiresAt};
+    return true;
+}
+
+std::string InMemoryStorage::loadOTP(const std::string& userId, const std::string& purpose,
+                                     int64_t now) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto user = otps.find(userId);
+    if (user == otps.end()) return "";
+    auto otp = user->second.find(purpose);
+    if (otp == user->second.end() || otp->second.expiresAt < now) return "";
+    return otp->second.code;
+}
+
+bool InMemoryStorage::consumeOTP(const std::string& userId, const std::string& purpose,
+                                 const std::string& otpCode, int64_t now) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto user = otps.find(userId);
+    if (user == otps.end()) return false;
+    auto otp = user->second.find(purpose);
+    if (otp == user->second.end() || otp->second.code != otpCode || otp->second.expiresAt < now) {
+        return false;
+    }
+    user->second.erase(otp);
+    return true;
+}
+
+void InMemoryStorage::removeOTP(const std::string& userId, const std::string& purpose) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto user = otps.find(userId);
+    if (user != otps.end()) {
+        user->second.erase(purpose);
+    }
+}
+
+int InMemoryStorage::removeExpiredOTPs(int64_t now) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    int removed = 0;
+    for (auto& user : otps) {
+        for (auto otp = user.second.begin(); otp != user.second.end();) {
+            if (otp->second.expiresAt < now) {
+                otp = user.second.erase(otp);
+                ++removed;
+            } else {
+                ++otp;
+            }
+        }
+    }
+    return removed;
+}
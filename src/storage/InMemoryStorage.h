@@ -0,0 +1,135 @@
+#ifndef IN_MEMORY_STORAGE_H
+#define IN_MEMORY_STORAGE_H
+
+#include "StorageBackend.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+#ifdef _WIN32
+    #include "../thread_compat.h"
+#else
+    #include <mutex>
+#endif
+
+// StorageBackend that keeps everything in process memory and forgets it on
+// exit. Lookups go through hash indexes (user ID, username, wallet ID,
+// owner, OTP user) and each wallet keeps an ordered index of its history for
+// keyset paging, so the business logic can be profiled without SQLite I/O.
+// It enforces the same rules as the database schema: unique usernames,
+// wallets owned by existing users, transactions between existing wallets.
+//
+// One mutex serializes all access. Transfers are applied on the calling
+// thread, so submitTransfer() returns a future that is already complete.
+class InMemoryStorage : public StorageBackend {
+private:
+    struct StoredUser {
+        User user;
+        uint64_t sequence;  // insertion order, for getMasterWalletId()
+    };
+
+    struct StoredWallet {
+        std::string ownerId;
+        double balance;
+        bool isLocked;
+    };
+
+    // Newest first, like the database's history queries
+    struct HistoryKey {
+        int64_t timestamp;
+        std::string transactionId;
+
+        bool operator<(const HistoryKey& other) const {
+            if (timestamp != other.timestamp) return timestamp > other.timestamp;
+            return transactionId > other.transactionId;
+        }
+    };
+    using HistoryIndex = std::map<HistoryKey, size_t>;  // position in `transactions`
+
+    struct StoredOtp {
+        std::string code;
+        int64_t expiresAt;
+    };
+
+    mutable std::mutex mutex;
+
+    std::unordered_map<std::string, StoredUser> users;
+    std::unordered_map<std::string, std::string> userIdsByUsername;
+    std::unordered_map<std::string, StoredWallet> wallets;
+    std::unordered_multimap<std::string, std::string> walletIdsByOwner;
+    std::vector<Transaction> transactions;  // append-only
+    std::unordered_map<std::string, size_t> transactionIndex;
+    std::unordered_map<std::string, HistoryIndex> history;
+    std::unordered_map<std::string, WalletFlowSummary> aggregates;
+    // user ID -> purpose -> code, so deleting a user drops its codes at once
+    std::unordered_map<std::string, std::unordered_map<std::string, StoredOtp>> otps;
+    SystemStats stats;
+    uint64_t nextUserSequence;
+
+    static int64_t toSeconds(const std::chrono::system_clock::time_point& time);
+    // Built the way DatabaseManager builds wallets from a row
+    static Wallet makeWallet(const std::string& walletId, const StoredWallet& stored);
+
+    // The callers hold `mutex`
+    void recordTransaction(const Transaction& transaction);
+    bool executeTransferLeg(const TransferRequest& request, TransferResult& result);
+    std::vector<Transaction> loadHistory(const std::string& walletId, const HistoryCursor& cursor,
+                                         size_t limit) const;
+
+public:
+    InMemoryStorage();
+
+    InMemoryStorage(const InMemoryStorage&) = delete;
+    InMemoryStorage& operator=(const InMemoryStorage&) = delete;
+
+    bool initialize() override;
+
+    using StorageBackend::saveUser;
+    using StorageBackend::saveWallet;
+
+    bool saveUser(const User& user) override;
+    std::unique_ptr<User> loadUserByUsername(const std::string& username) override;
+    std::unique_ptr<User> loadUserById(const std::string& userId) override;
+    // Visits a snapshot taken up front, in no particular order. Every field
+    // is filled whatever `columns` asks for.
+    size_t forEachUser(const UserVisitor& visitor, unsigned columns = USER_COLUMNS_ALL) override;
+    std::vector<std::shared_ptr<User>> loadAllUsers() override;
+    bool deleteUser(const std::string& userId) override;
+    std::vector<std::string> importAccounts(const std::vector<NewAccount>& accounts) override;
+
+    bool saveWallet(const Wallet& wallet) override;
+    std::shared_ptr<Wallet> loadWallet(const std::string& walletId) override;
+    std::shared_ptr<Wallet> loadWalletByOwnerId(const std::string& ownerId) override;
+    size_t forEachWallet(const WalletVisitor& visitor) override;
+
+    std::string transferPointsWithId(const std::string& fromWalletId,
+                                     const std::string& toWalletId,
+                                     double amount,
+                                     const std::string& description) override;
+    std::vector<TransferResult> transferPointsBatch(const std::vector<TransferRequest>& requests) override;
+    // onCommitted runs on the calling thread before this returns
+    std::future<TransferResult> submitTransfer(const TransferRequest& request,
+                                               TransferCallback onCommitted = nullptr) override;
+
+    std::string getMasterWalletId() override;
+    bool saveTransaction(const Transaction& transaction) override;
+    TransactionPage loadTransactionPage(const std::string& walletId,
+                                        const HistoryCursor& cursor = HistoryCursor(),
+                                        size_t pageSize = DEFAULT_HISTORY_PAGE_SIZE) override;
+    WalletFlowSummary loadWalletFlowSummary(const std::string& walletId) override;
+    bool loadSystemStats(SystemStats& stats) const override;
+
+    bool saveOTP(const std::string& userId, const std::string& purpose,
+                 const std::string& otpCode, int64_t expiresAt) override;
+    std::string loadOTP(const std::string& userId, const std::string& purpose, int64_t now) override;
+    bool consumeOTP(const std::string& userId, const std::string& purpose,
+                    const std::string& otpCode, int64_t now) override;
+    void removeOTP(const std::string& userId, const std::string& purpose) override;
+    int removeExpiredOTPs(int64_t now) override;
+};
+
+#endif
@@ -0,0 +1,338 @@
+#include "LedgerJournal.h"
+#include "../models/Uuid.h"
+#include <iostream>
+#include <cstring>
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+static const char LEDGER_MAGIC[8] = {'W', 'L', 'E', 'D', 'G', 'E', 'R', '1'};
+static const uint32_t LEDGER_VERSION = 1;
+
+// Record field offsets
+static const size_t SEQUENCE_OFFSET = 0;
+static const size_t TIMESTAMP_OFFSET = 8;
+static const size_t AMOUNT_OFFSET = 16;
+static const size_t TRANSACTION_ID_OFFSET = 24;
+static const size_t FROM_WALLET_OFFSET = 40;
+static const size_t TO_WALLET_OFFSET = 56;
+static const size_t DESCRIPTION_OFFSET = 72;
+static const size_t RECORD_CHECKSUM_OFFSET = LedgerJournal::RECORD_SIZE - 4;
+static const size_t HEADER_CHECKSUM_OFFSET = LedgerJournal::HEADER_SIZE - 4;
+
+// CRC-32C (Castagnoli), table-driven
+static uint32_t crc32c(const uint8_t* data, size_t length) {
+    static uint32_t table[256];
+    static bool initialized = [] {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+            }
+            table[i] = crc;
+        }
+        return true;
+    }();
+    (void)initialized;
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static void put32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static void put64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static uint32_t get32(const uint8_t* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(in[i]) << (8 * i);
+    return value;
+}
+
+static uint64_t get64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return value;
+}
+
+// Longest prefix of at most `limit` bytes that does not split a UTF-8 character
+static size_t utf8Prefix(const std::string& text, size_t limit) {
+    if (text.size() <= limit) return text.size();
+    size_t length = limit;
+    while (length > 0 && (static_cast<unsigned char>(text[length]) & 0xC0) == 0x80) {
+        --length;
+    }
+    return length;
+}
+
+LedgerJournal::LedgerJournal(const std::string& path)
+    : path(path),
+#ifdef _WIN32
+      fileHandle(INVALID_HANDLE_VALUE),
+      mappingHandle(nullptr),
+#else
+      fd(-1),
+#endif
+      base(nullptr), mappedSize(0), firstSequence(1), recordCount(0), syncedCount(0) {
+}
+
+LedgerJournal::~LedgerJournal() {
+    close();
+}
+
+bool LedgerJournal::map(size_t size) {
+    unmap();
+#ifdef _WIN32
+    LARGE_INTEGER fileSize;
+    fileSize.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(fileHandle, fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(fileHandle)) {
+        return false;
+    }
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (!mappingHandle) return false;
+    void* view = MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+        return false;
+    }
+#else
+    struct stat st;
+    if (fstat(fd, &st) != 0) return false;
+    if (static_cast<size_t>(st.st_size) != size) {
+        // The new length must be durable before records past the old end are
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0 || fsync(fd) != 0) {
+            return false;
+        }
+    }
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) return false;
+#endif
+    base = static_cast<uint8_t*>(view);
+    mappedSize = size;
+    return true;
+}
+
+void LedgerJournal::unmap() {
+    if (!base) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(mappingHandle);
+    mappingHandle = nullptr;
+#else
+    munmap(base, mappedSize);
+#endif
+    base = nullptr;
+    mappedSize = 0;
+}
+
+bool LedgerJournal::flush(size_t offset, size_t length) {
+#ifdef _WIN32
+    return FlushViewOfFile(base + offset, length) && FlushFileBuffers(fileHandle);
+#else
+    // msync wants a page-aligned start
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset - offset % pageSize;
+    return msync(base + alignedOffset, length + (offset - alignedOffset), MS_SYNC) == 0;
+#endif
+}
+
+bool LedgerJournal::writeHeader() {
+    std::memset(base, 0, HEADER_SIZE);
+    std::memcpy(base, LEDGER_MAGIC, sizeof(LEDGER_MAGIC));
+    put32(base + 8, LEDGER_VERSION);
+    put32(base + 12, static_cast<uint32_t>(RECORD_SIZE));
+    put64(base + 16, firstSequence);
+    put32(base + HEADER_CHECKSUM_OFFSET, crc32c(base, HEADER_CHECKSUM_OFFSET));
+    return flush(0, HEADER_SIZE);
+}
+
+bool LedgerJournal::readHeader() {
+    if (std::memcmp(base, LEDGER_MAGIC, sizeof(LEDGER_MAGIC)) != 0 ||
+        get32(base + HEADER_CHECKSUM_OFFSET) != crc32c(base, HEADER_CHECKSUM_OFFSET)) {
+        std::cerr << "Ledger journal header is corrupt: " << path << std::endl;
+        return false;
+    }
+    if (get32(base + 8) != LEDGER_VERSION || get32(base + 12) != RECORD_SIZE) {
+        std::cerr << "Unsupported ledger journal format: " << path << std::endl;
+        return false;
+    }
+    firstSequence = get64(base + 16);
+    return true;
+}
+
+bool LedgerJournal::open(std::vector<LedgerEntry>& entries) {
+    entries.clear();
+    close();
+
+    size_t fileSize = 0;
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                             OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &size)) {
+        std::cerr << "Cannot open ledger journal: " << path << std::endl;
+        close();
+        return false;
+    }
+    fileSize = static_cast<size_t>(size.QuadPart);
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "Cannot open ledger journal: " << path << std::endl;
+        close();
+        return false;
+    }
+    fileSize = static_cast<size_t>(st.st_size);
+#endif
+
+    bool isNew = fileSize < HEADER_SIZE;
+    size_t records = isNew ? GROWTH_RECORDS : (fileSize - HEADER_SIZE) / RECORD_SIZE;
+    if (!map(HEADER_SIZE + records * RECORD_SIZE)) {
+        std::cerr << "Cannot map ledger journal: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    if (isNew) {
+        firstSequence = 1;
+        if (!writeHeader()) {
+            close();
+            return false;
+        }
+    } else if (!readHeader()) {
+        close();
+        return false;
+    }
+
+    // Everything after the first bad record was never acknowledged
+    recordCount = 0;
+    while (recordCount < capacity()) {
+        const uint8_t* record = slot(recordCount);
+        if (get32(record + RECORD_CHECKSUM_OFFSET) != crc32c(record, RECORD_CHECKSUM_OFFSET) ||
+            get64(record + SEQUENCE_OFFSET) != firstSequence + recordCount) {
+            break;
+        }
+
+        LedgerEntry entry;
+        entry.sequence = get64(record + SEQUENCE_OFFSET);
+        entry.timestamp = static_cast<int64_t>(get64(record + TIMESTAMP_OFFSET));
+        uint64_t amountBits = get64(record + AMOUNT_OFFSET);
+        std::memcpy(&entry.amount, &amountBits, sizeof(entry.amount));
+        entry.transactionId = Uuid(record + TRANSACTION_ID_OFFSET).toString();
+        entry.fromWalletId = Uuid(record + FROM_WALLET_OFFSET).toString();
+        entry.toWalletId = Uuid(record + TO_WALLET_OFFSET).toString();
+        const char* description = reinterpret_cast<const char*>(record + DESCRIPTION_OFFSET);
+        entry.description.assign(description, strnlen(description, DESCRIPTION_SIZE));
+        entries.push_back(entry);
+        ++recordCount;
+    }
+    syncedCount = recordCount;
+    return true;
+}
+
+void LedgerJournal::close() {
+    unmap();
+#ifdef _WIN32
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+    recordCount = 0;
+    syncedCount = 0;
+}
+
+bool LedgerJournal::canEncode(const LedgerEntry& entry) {
+    Uuid uuid;
+    return Uuid::parse(entry.transactionId, uuid) &&
+           Uuid::parse(entry.fromWalletId, uuid) &&
+           Uuid::parse(entry.toWalletId, uuid);
+}
+
+bool LedgerJournal::append(LedgerEntry& entry) {
+    if (!base || !canEncode(entry)) return false;
+    if (recordCount == capacity() && !map(mappedSize + GROWTH_RECORDS * RECORD_SIZE)) {
+        std::cerr << "Cannot grow ledger journal: " << path << std::endl;
+        return false;
+    }
+
+    entry.sequence = firstSequence + recordCount;
+
+    uint8_t* record = slot(recordCount);
+    std::memset(record, 0, RECORD_SIZE);
+    put64(record + SEQUENCE_OFFSET, entry.sequence);
+    put64(record + TIMESTAMP_OFFSET, static_cast<uint64_t>(entry.timestamp));
+    uint64_t amountBits;
+    std::memcpy(&amountBits, &entry.amount, sizeof(amountBits));
+    put64(record + AMOUNT_OFFSET, amountBits);
+
+    Uuid uuid;
+    Uuid::parse(entry.transactionId, uuid);
+    std::memcpy(record + TRANSACTION_ID_OFFSET, uuid.data(), Uuid::SIZE);
+    Uuid::parse(entry.fromWalletId, uuid);
+    std::memcpy(record + FROM_WALLET_OFFSET, uuid.data(), Uuid::SIZE);
+    Uuid::parse(entry.toWalletId, uuid);
+    std::memcpy(record + TO_WALLET_OFFSET, uuid.data(), Uuid::SIZE);
+
+    entry.description.resize(utf8Prefix(entry.description, DESCRIPTION_SIZE));
+    std::memcpy(record + DESCRIPTION_OFFSET, entry.description.data(), entry.description.size());
+
+    put32(record + RECORD_CHECKSUM_OFFSET, crc32c(record, RECORD_CHECKSUM_OFFSET));
+    ++recordCount;
+    return true;
+}
+
+bool LedgerJournal::sync() {
+    if (!base) return false;
+    if (syncedCount == recordCount) return true;
+
+    size_t offset = HEADER_SIZE + syncedCount * RECORD_SIZE;
+    if (!flush(offset, (recordCount - syncedCount) * RECORD_SIZE)) {
+        std::cerr << "Cannot flush ledger journal: " << path << std::endl;
+        return false;
+    }
+    syncedCount = recordCount;
+    return true;
+}
+
+void LedgerJournal::discardUnsynced() {
+    if (!base || syncedCount == recordCount) return;
+
+    // Some of these pages may have reached the disk already; zeroed slots
+    // fail the checksum on the next open
+    size_t offset = HEADER_SIZE + syncedCount * RECORD_SIZE;
+    size_t length = (recordCount - syncedCount) * RECORD_SIZE;
+    std::memset(base + offset, 0, length);
+    flush(offset, length);
+    recordCount = syncedCount;
+}
+
+bool LedgerJournal::reset(uint64_t nextSequence) {
+    if (!base) return false;
+
+    // Old records stay in place but no longer match the sequence the
+    // header expects, so the journal reads back empty from here on
+    firstSequence = nextSequence;
+    recordCount = 0;
+    syncedCount = 0;
+    return writeHeader();
+}
@@ -0,0 +1,95 @@
+#ifndef LEDGER_JOURNAL_H
+#define LEDGER_JOURNAL_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// One transfer as recorded in the journal
+struct LedgerEntry {
+    uint64_t sequence = 0;
+    int64_t timestamp = 0;  // seconds since epoch
+    double amount = 0.0;
+    std::string transactionId;
+    std::string fromWalletId;
+    std::string toWalletId;
+    std::string description;  // cut to DESCRIPTION_SIZE bytes when written
+};
+
+// Append-only file of fixed-size, checksummed transfer records, written
+// through a shared memory mapping. Appending is a copy into the mapping;
+// sync() then flushes every record appended since the last call with one
+// msync (FlushViewOfFile on Windows), so a group of transfers costs a
+// single flush. Sequence numbers are consecutive, starting at the header's
+// first sequence.
+//
+// On open the records are read back up to the first one whose checksum or
+// sequence is wrong: that is where an interrupted append stopped, and the
+// slots from there on are reused. The file grows GROWTH_RECORDS at a time.
+//
+// Layout (little-endian): a HEADER_SIZE-byte header (magic, version,
+// record size, first sequence, CRC-32C), then RECORD_SIZE-byte records:
+// sequence, timestamp, amount, transaction ID and both wallet IDs as
+// 16-byte UUIDs, a zero-padded description, CRC-32C of everything before it.
+//
+// Not thread-safe; one owner appends, syncs and resets.
+class LedgerJournal {
+public:
+    static const size_t HEADER_SIZE = 64;
+    static const size_t RECORD_SIZE = 256;
+    static const size_t DESCRIPTION_SIZE = 176;
+    static const size_t GROWTH_RECORDS = 4096;  // 1 MiB
+
+private:
+    std::string path;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+    uint8_t* base;
+    size_t mappedSize;
+    uint64_t firstSequence;
+    size_t recordCount;
+    size_t syncedCount;
+
+    size_t capacity() const { return (mappedSize - HEADER_SIZE) / RECORD_SIZE; }
+    uint8_t* slot(size_t index) const { return base + HEADER_SIZE + index * RECORD_SIZE; }
+
+    // Resizes the file to `size` bytes and maps all of it
+    bool map(size_t size);
+    void unmap();
+    bool flush(size_t offset, size_t length);
+    bool writeHeader();
+    bool readHeader();
+
+public:
+    explicit LedgerJournal(const std::string& path);
+    ~LedgerJournal();
+
+    LedgerJournal(const LedgerJournal&) = delete;
+    LedgerJournal& operator=(const LedgerJournal&) = delete;
+
+    // Opens (or creates) the file and returns its valid records in order
+    bool open(std::vector<LedgerEntry>& entries);
+    void close();
+
+    // IDs must be canonical UUIDs, as generated by SecurityUtils
+    static bool canEncode(const LedgerEntry& entry);
+
+    // Writes the entry at the next sequence (returned in entry.sequence);
+    // it is durable once sync() returns true
+    bool append(LedgerEntry& entry);
+    bool sync();
+    // Drops the records appended since the last successful sync()
+    void discardUnsynced();
+    // Empties the journal; the next record is numbered `nextSequence`
+    bool reset(uint64_t nextSequence);
+
+    uint64_t getNextSequence() const { return firstSequence + recordCount; }
+    size_t size() const { return recordCount; }
+};
+
+#endif
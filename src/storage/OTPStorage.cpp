@@ -1,81 +1,61 @@
 #include "OTPStorage.h"
-#include <sqlite3.h>
-#include <iostream>
+#include "StorageBackend.h"
 #include <chrono>
+#include <cstdint>
+#ifdef _WIN32
+    #include "../thread_compat.h"
+#else
+    #include <mutex>
+#endif
+
+static std::mutex managerMutex;
+static std::weak_ptr<StorageBackend> attachedManager;
+
+static int64_t nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void OTPStorage::attach(std::weak_ptr<StorageBackend> manager) {
+    std::lock_guard<std::mutex> lock(managerMutex);
+    attachedManager = manager;
+}
 
-static const char* DB_PATH = "data/wallet_system.db";
+std::shared_ptr<StorageBackend> OTPStorage::manager() {
+    std::lock_guard<std::mutex> lock(managerMutex);
+    return attachedManager.lock();
+}
 
 bool OTPStorage::saveOTP(const std::string& userId, const std::string& purpose,
                         const std::string& otpCode, int expiresAfterSec) {
-    sqlite3* db;
-    if (sqlite3_open(DB_PATH, &db) != SQLITE_OK) return false;
-    sqlite3_stmt* stmt = nullptr;
-
-    // Xoá OTP cũ (nếu có) cho userId + purpose
-    const char* delSQL = "DELETE FROM otps WHERE user_id=? AND purpose=?;";
-    sqlite3_prepare_v2(db, delSQL, -1, &stmt, nullptr);
-    sqlite3_bind_text(stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, purpose.c_str(), -1, SQLITE_STATIC);
-    sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-
-    // Thêm OTP mới
-    int expires = static_cast<int>(std::chrono::system_clock::to_time_t(
-        std::chrono::system_clock::now() + std::chrono::seconds(expiresAfterSec)));
-
-    const char* insSQL = "INSERT INTO otps(user_id, purpose, otp_code, expires_at) VALUES (?, ?, ?, ?);";
-    sqlite3_prepare_v2(db, insSQL, -1, &stmt, nullptr);
-    sqlite3_bind_text(stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, purpose.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, otpCode.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 4, expires);
-    bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    return ok;
+    auto db = manager();
+    if (!db) return false;
+    return db->saveOTP(userId, purpose, otpCode, nowSeconds() + expiresAfterSec);
 }
 
 std::string OTPStorage::getOTP(const std::string& userId, const std::string& purpose) {
-    sqlite3* db;
-    if (sqlite3_open(DB_PATH, &db) != SQLITE_OK) return "";
-    sqlite3_stmt* stmt = nullptr;
-    std::string otp = "";
-    int now = static_cast<int>(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
-    const char* sql = "SELECT otp_code FROM otps WHERE user_id=? AND purpose=? AND expires_at>=?;";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    sqlite3_bind_text(stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, purpose.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 3, now);
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        otp = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-    }
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-    return otp;
+    auto db = manager();
+    if (!db) return "";
+    return db->loadOTP(userId, purpose, nowSeconds());
+}
+
+bool OTPStorage::consumeOTP(const std::string& userId, const std::string& purpose,
+                            const std::string& otpCode) {
+    auto db = manager();
+    if (!db) return false;
+    return db->consumeOTP(userId, purpose, otpCode, nowSeconds());
 }
 
 void OTPStorage::removeOTP(const std::string& userId, const std::string& purpose) {
-    sqlite3* db;
-    if (sqlite3_open(DB_PATH, &db) != SQLITE_OK) return;
-    sqlite3_stmt* stmt = nullptr;
-    const char* sql = "DELETE FROM otps WHERE user_id=? AND purpose=?;";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    sqlite3_bind_text(stmt, 1, userId.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, purpose.c_str(), -1, SQLITE_STATIC);
-    sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    auto db = manager();
+    if (db) {
+        db->removeOTP(userId, purpose);
+    }
 }
 
 void OTPStorage::cleanupExpiredOTP() {
-    sqlite3* db;
-    if (sqlite3_open(DB_PATH, &db) != SQLITE_OK) return;
-    sqlite3_stmt* stmt = nullptr;
-    int now = static_cast<int>(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
-    const char* sql = "DELETE FROM otps WHERE expires_at < ?;";
-    sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
-    sqlite3_bind_int(stmt, 1, now);
-    sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
-}
\ No newline at end of file
+    auto db = manager();
+    if (db) {
+        db->removeExpiredOTPs(nowSeconds());
+    }
+}
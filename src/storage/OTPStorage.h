@@ -1,9 +1,17 @@
 #pragma once
 #include <string>
 #include <chrono>
+#include <memory>
+
+class StorageBackend;
 
 class OTPStorage {
 public:
+    // Routes OTP persistence through the attached storage backend (for SQLite,
+    // its long-lived writer connection). Until one is attached every
+    // operation fails.
+    static void attach(std::weak_ptr<StorageBackend> manager);
+
     // Lưu OTP vào DB
     static bool saveOTP(const std::string& userId, const std::string& purpose,
                         const std::string& otpCode, int expiresAfterSec = 300);
@@ -11,9 +19,16 @@ public:
     // Lấy OTP (nếu còn hạn)
     static std::string getOTP(const std::string& userId, const std::string& purpose);
 
+    // Kiểm tra và xóa OTP trong một câu lệnh (chỉ thành công một lần)
+    static bool consumeOTP(const std::string& userId, const std::string& purpose,
+                           const std::string& otpCode);
+
     // Xóa OTP (sau khi dùng hoặc hết hạn)
     static void removeOTP(const std::string& userId, const std::string& purpose);
 
     // Xóa tất cả OTP đã hết hạn (chạy định kỳ)
     static void cleanupExpiredOTP();
+
+private:
+    static std::shared_ptr<StorageBackend> manager();
 };
\ No newline at end of file
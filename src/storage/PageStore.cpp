@@ -0,0 +1,493 @@
+#include "PageStore.h"
+#include "FileCopy.h"
+#include "../security/picosha2.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_set>
+#include <future>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+static const char PACK_MAGIC[8] = {'P', 'G', 'P', 'A', 'C', 'K', '0', '1'};
+static const char INDEX_MAGIC[8] = {'P', 'G', 'I', 'N', 'D', 'X', '0', '1'};
+static const char MANIFEST_MAGIC[8] = {'P', 'G', 'M', 'A', 'N', 'I', '0', '1'};
+static const size_t HEADER_SIZE = 16;          // magic, u64 generation
+static const size_t MANIFEST_HEADER_SIZE = 20; // magic, u32 page size, u64 page count
+static const size_t RECORD_HEADER_SIZE = 36;   // hash, u32 length
+static const size_t INDEX_RECORD_SIZE = 44;    // hash, u64 offset, u32 length
+static const uint32_t MAX_PAGE_SIZE = 65536;
+
+static void putLittleEndian(unsigned char* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+static uint64_t getLittleEndian(const unsigned char* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+static bool writeHeader(FILE* file, const char magic[8], uint64_t generation) {
+    unsigned char header[HEADER_SIZE];
+    std::memcpy(header, magic, 8);
+    putLittleEndian(header + 8, generation, 8);
+    return std::fwrite(header, 1, HEADER_SIZE, file) == HEADER_SIZE;
+}
+
+static bool writeIndexRecord(FILE* file, const PageStore::PageHash& hash, uint64_t offset, uint32_t length) {
+    unsigned char record[INDEX_RECORD_SIZE];
+    std::memcpy(record, hash.data(), hash.size());
+    putLittleEndian(record + 32, offset, 8);
+    putLittleEndian(record + 40, length, 4);
+    return std::fwrite(record, 1, INDEX_RECORD_SIZE, file) == INDEX_RECORD_SIZE;
+}
+
+static bool writePackRecord(FILE* file, const PageStore::PageHash& hash,
+                            const unsigned char* data, uint32_t length) {
+    unsigned char header[RECORD_HEADER_SIZE];
+    std::memcpy(header, hash.data(), hash.size());
+    putLittleEndian(header + 32, length, 4);
+    return std::fwrite(header, 1, RECORD_HEADER_SIZE, file) == RECORD_HEADER_SIZE &&
+           std::fwrite(data, 1, length, file) == length;
+}
+
+// Hashes `count` pages of `batch`, splitting them across up to `threads` tasks
+static void hashPages(const std::vector<unsigned char>& batch, uint32_t pageSize, size_t count,
+                      std::vector<PageStore::PageHash>& hashes, unsigned threads) {
+    size_t tasks = std::min<size_t>(threads, count);
+    size_t perTask = (count + tasks - 1) / tasks;
+    std::vector<std::future<void>> pending;
+    for (size_t first = 0; first < count; first += perTask) {
+        size_t last = std::min(count, first + perTask);
+        pending.push_back(std::async(std::launch::async, [&batch, &hashes, pageSize, first, last]() {
+            for (size_t i = first; i < last; ++i) {
+                const unsigned char* page = batch.data() + i * pageSize;
+                picosha2::hash256(page, page + pageSize, hashes[i].begin(), hashes[i].end());
+            }
+        }));
+    }
+    for (auto& task : pending) {
+        task.get();
+    }
+}
+
+size_t PageStore::PageHashHasher::operator()(const PageHash& hash) const {
+    // Already uniformly distributed; the first bytes are enough
+    size_t value;
+    std::memcpy(&value, hash.data(), sizeof(value));
+    return value;
+}
+
+PageStore::PageStore(const std::string& directory)
+    : directory(directory),
+      packPath(directory + "/pages.pack"),
+      indexPath(directory + "/pages.idx"),
+      manifestDirectory(directory + "/manifests"),
+      loaded(false),
+      generation(0),
+      packSize(0) {
+}
+
+bool PageStore::isManifest(const std::string& path) {
+    const std::string suffix = ".manifest";
+    return path.size() > suffix.size() &&
+           path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool PageStore::ensureLoaded() {
+    if (loaded) return true;
+
+    std::error_code ec;
+    fs::create_directories(manifestDirectory, ec);
+
+    if (!fs::exists(packPath, ec)) {
+        loaded = createStore();
+        return loaded;
+    }
+
+    std::ifstream pack(packPath, std::ios::binary);
+    unsigned char header[HEADER_SIZE];
+    if (!pack.read(reinterpret_cast<char*>(header), HEADER_SIZE) ||
+        std::memcmp(header, PACK_MAGIC, 8) != 0) {
+        std::cerr << "Backup page store is damaged: " << packPath << std::endl;
+        return false;
+    }
+    pack.close();
+    generation = getLittleEndian(header + 8, 8);
+    packSize = fs::file_size(packPath, ec);
+
+    uint64_t indexedEnd = HEADER_SIZE;
+    if (!loadIndex(indexedEnd)) {
+        // Missing, or left over from before the last compaction: rebuild
+        index.clear();
+        indexedEnd = HEADER_SIZE;
+        FILE* file = std::fopen(indexPath.c_str(), "wb");
+        bool ok = file && writeHeader(file, INDEX_MAGIC, generation);
+        if (file) ok = std::fclose(file) == 0 && ok;
+        if (!ok) return false;
+    }
+
+    loaded = indexPackTail(indexedEnd);
+    return loaded;
+}
+
+bool PageStore::createStore() {
+    generation = 1;
+    packSize = HEADER_SIZE;
+    index.clear();
+
+    FILE* pack = std::fopen(packPath.c_str(), "wb");
+    bool ok = pack && writeHeader(pack, PACK_MAGIC, generation);
+    if (pack) ok = std::fclose(pack) == 0 && ok;
+
+    FILE* idx = ok ? std::fopen(indexPath.c_str(), "wb") : nullptr;
+    ok = idx && writeHeader(idx, INDEX_MAGIC, generation);
+    if (idx) ok = std::fclose(idx) == 0 && ok;
+
+    if (!ok) {
+        std::cerr << "Cannot create backup page store in " << directory << std::endl;
+    }
+    return ok;
+}
+
+bool PageStore::loadIndex(uint64_t& indexedEnd) {
+    std::ifstream idx(indexPath, std::ios::binary);
+    unsigned char header[HEADER_SIZE];
+    if (!idx.read(reinterpret_cast<char*>(header), HEADER_SIZE) ||
+        std::memcmp(header, INDEX_MAGIC, 8) != 0 ||
+        getLittleEndian(header + 8, 8) != generation) {
+        return false;
+    }
+
+    unsigned char record[INDEX_RECORD_SIZE];
+    uint64_t records = 0;
+    while (idx.read(reinterpret_cast<char*>(record), INDEX_RECORD_SIZE)) {
+        PageHash hash;
+        std::memcpy(hash.data(), record, hash.size());
+        PageLocation location{getLittleEndian(record + 32, 8),
+                              static_cast<uint32_t>(getLittleEndian(record + 40, 4))};
+        if (location.offset + location.length > packSize) {
+            return false;
+        }
+        index[hash] = location;
+        indexedEnd = std::max(indexedEnd, location.offset + location.length);
+        ++records;
+    }
+    idx.close();
+
+    // Drop a torn record so later appends stay aligned
+    std::error_code ec;
+    fs::resize_file(indexPath, HEADER_SIZE + records * INDEX_RECORD_SIZE, ec);
+    return !ec;
+}
+
+bool PageStore::indexPackTail(uint64_t from) {
+    if (from >= packSize) return true;
+
+    std::ifstream pack(packPath, std::ios::binary);
+    FILE* idx = std::fopen(indexPath.c_str(), "ab");
+    if (!pack || !idx) {
+        if (idx) std::fclose(idx);
+        return false;
+    }
+    pack.seekg(static_cast<std::streamoff>(from));
+
+    std::vector<unsigned char> data(MAX_PAGE_SIZE);
+    unsigned char header[RECORD_HEADER_SIZE];
+    uint64_t position = from;
+    bool ok = true;
+    while (position + RECORD_HEADER_SIZE <= packSize &&
+           pack.read(reinterpret_cast<char*>(header), RECORD_HEADER_SIZE)) {
+        uint32_t length = static_cast<uint32_t>(getLittleEndian(header + 32, 4));
+        if (length == 0 || length > MAX_PAGE_SIZE ||
+            position + RECORD_HEADER_SIZE + length > packSize ||
+            !pack.read(reinterpret_cast<char*>(data.data()), length)) {
+            break;
+        }
+
+        PageHash hash, actual;
+        std::memcpy(hash.data(), header, hash.size());
+        picosha2::hash256(data.begin(), data.begin() + length, actual.begin(), actual.end());
+        if (hash != actual) break;
+
+        PageLocation location{position + RECORD_HEADER_SIZE, length};
+        index[hash] = location;
+        ok = writeIndexRecord(idx, hash, location.offset, length) && ok;
+        position += RECORD_HEADER_SIZE + length;
+    }
+    ok = std::fclose(idx) == 0 && ok;
+
+    // A crash during ingest can leave a partial record at the end
+    if (position < packSize) {
+        std::cerr << "Discarding incomplete data at the end of " << packPath << std::endl;
+        std::error_code ec;
+        fs::resize_file(packPath, position, ec);
+        packSize = position;
+    }
+    return ok;
+}
+
+bool PageStore::readManifest(const std::string& path, uint32_t& pageSize, std::vector<PageHash>& pages) {
+    std::ifstream manifest(path, std::ios::binary | std::ios::ate);
+    if (!manifest) return false;
+    uint64_t fileSize = static_cast<uint64_t>(manifest.tellg());
+    manifest.seekg(0);
+
+    unsigned char header[MANIFEST_HEADER_SIZE];
+    if (!manifest.read(reinterpret_cast<char*>(header), MANIFEST_HEADER_SIZE) ||
+        std::memcmp(header, MANIFEST_MAGIC, 8) != 0) {
+        return false;
+    }
+    pageSize = static_cast<uint32_t>(getLittleEndian(header + 8, 4));
+    uint64_t pageCount = getLittleEndian(header + 12, 8);
+    if (fileSize != MANIFEST_HEADER_SIZE + pageCount * sizeof(PageHash)) {
+        return false;
+    }
+
+    pages.resize(static_cast<size_t>(pageCount));
+    return pageCount == 0 ||
+           static_cast<bool>(manifest.read(reinterpret_cast<char*>(pages.data()),
+                                           static_cast<std::streamsize>(pageCount * sizeof(PageHash))));
+}
+
+std::string PageStore::ingest(const std::string& databasePath, const std::string& backupId) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    if (!ensureLoaded()) return "";
+
+    std::ifstream db(databasePath, std::ios::binary);
+    unsigned char dbHeader[100];
+    if (!db.read(reinterpret_cast<char*>(dbHeader), sizeof(dbHeader)) ||
+        std::memcmp(dbHeader, "SQLite format 3", 16) != 0) {
+        std::cerr << "Not a database file: " << databasePath << std::endl;
+        return "";
+    }
+    // Page size is a big-endian u16 at offset 16; 1 stands for 65536
+    uint32_t pageSize = (uint32_t(dbHeader[16]) << 8) | dbHeader[17];
+    if (pageSize == 1) pageSize = MAX_PAGE_SIZE;
+
+    std::error_code ec;
+    uint64_t fileSize = fs::file_size(databasePath, ec);
+    if (ec || pageSize < 512 || (pageSize & (pageSize - 1)) != 0 || fileSize % pageSize != 0) {
+        std::cerr << "Unexpected database layout: " << databasePath << std::endl;
+        return "";
+    }
+    uint64_t pageCount = fileSize / pageSize;
+    db.seekg(0);
+
+    std::string manifestPath = manifestDirectory + "/" + backupId + ".manifest";
+    std::string partialPath = manifestPath + ".part";
+    FILE* manifest = std::fopen(partialPath.c_str(), "wb");
+    FILE* pack = std::fopen(packPath.c_str(), "ab");
+
+    unsigned char manifestHeader[MANIFEST_HEADER_SIZE];
+    std::memcpy(manifestHeader, MANIFEST_MAGIC, 8);
+    putLittleEndian(manifestHeader + 8, pageSize, 4);
+    putLittleEndian(manifestHeader + 12, pageCount, 8);
+    bool ok = manifest && pack &&
+              std::fwrite(manifestHeader, 1, MANIFEST_HEADER_SIZE, manifest) == MANIFEST_HEADER_SIZE;
+
+    unsigned threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 2;
+
+    std::vector<unsigned char> batch(INGEST_BATCH_PAGES * pageSize);
+    std::vector<PageHash> hashes(INGEST_BATCH_PAGES);
+    std::vector<std::pair<PageHash, PageLocation>> added;
+    uint64_t remaining = pageCount;
+
+    while (ok && remaining > 0) {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(INGEST_BATCH_PAGES, remaining));
+        if (!db.read(reinterpret_cast<char*>(batch.data()), static_cast<std::streamsize>(count * pageSize))) {
+            ok = false;
+            break;
+        }
+        hashPages(batch, pageSize, count, hashes, threads);
+
+        for (size_t i = 0; ok && i < count; ++i) {
+            ok = std::fwrite(hashes[i].data(), 1, hashes[i].size(), manifest) == hashes[i].size();
+            if (!ok || index.count(hashes[i])) continue;
+
+            PageLocation location{packSize + RECORD_HEADER_SIZE, pageSize};
+            ok = writePackRecord(pack, hashes[i], batch.data() + i * pageSize, pageSize);
+            packSize += RECORD_HEADER_SIZE + pageSize;
+            index.emplace(hashes[i], location);
+            added.emplace_back(hashes[i], location);
+        }
+        remaining -= count;
+    }
+
+    if (manifest) ok = std::fclose(manifest) == 0 && ok;
+    if (pack) ok = std::fclose(pack) == 0 && ok;
+
+    // New pages must be on disk before any manifest refers to them; the
+    // index only speeds up loading and is rebuilt from the pack if behind
+    ok = ok && FileCopy::sync(packPath) && FileCopy::sync(partialPath);
+    if (ok) {
+        FILE* idx = std::fopen(indexPath.c_str(), "ab");
+        bool indexed = idx != nullptr;
+        for (size_t i = 0; indexed && i < added.size(); ++i) {
+            indexed = writeIndexRecord(idx, added[i].first, added[i].second.offset, added[i].second.length);
+        }
+        if (idx) std::fclose(idx);
+        ok = FileCopy::replace(partialPath, manifestPath);
+    }
+
+    if (!ok) {
+        std::cerr << "Cannot add backup to page store: " << databasePath << std::endl;
+        std::remove(partialPath.c_str());
+        // Reload from disk next time rather than trust the in-memory index
+        loaded = false;
+        index.clear();
+        return "";
+    }
+    return manifestPath;
+}
+
+bool PageStore::materialize(const std::string& manifestPath, const std::string& outputPath) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    if (!ensureLoaded()) return false;
+
+    uint32_t pageSize = 0;
+    std::vector<PageHash> pages;
+    if (!readManifest(manifestPath, pageSize, pages)) {
+        std::cerr << "Cannot read backup manifest: " << manifestPath << std::endl;
+        return false;
+    }
+
+    std::ifstream pack(packPath, std::ios::binary);
+    std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+    if (!pack || !output) return false;
+
+    std::vector<char> page(MAX_PAGE_SIZE);
+    for (const auto& hash : pages) {
+        auto it = index.find(hash);
+        if (it == index.end()) {
+            std::cerr << "Backup page missing from page store: " << manifestPath << std::endl;
+            return false;
+        }
+        pack.seekg(static_cast<std::streamoff>(it->second.offset));
+        if (!pack.read(page.data(), it->second.length) || !output.write(page.data(), it->second.length)) {
+            return false;
+        }
+    }
+    return static_cast<bool>(output.flush());
+}
+
+uint64_t PageStore::collectGarbage(const std::unordered_set<std::string>& backupIds) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    if (!ensureLoaded()) return 0;
+
+    // Mark: every page some recorded manifest still lists
+    std::unordered_set<PageHash, PageHashHasher> live;
+    std::error_code ec;
+    for (fs::directory_iterator it(manifestDirectory, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string path = it->path().string();
+        if (!isManifest(path)) {
+            std::remove(path.c_str());   // unfinished ingest
+            continue;
+        }
+        if (!backupIds.count(it->path().stem().string())) {
+            std::remove(path.c_str());   // its backup never made it into the catalog
+            continue;
+        }
+        uint32_t pageSize = 0;
+        std::vector<PageHash> pages;
+        if (!readManifest(path, pageSize, pages)) {
+            // Its pages cannot be told apart, so keep everything
+            std::cerr << "Skipping page store cleanup, unreadable manifest: " << path << std::endl;
+            return 0;
+        }
+        live.insert(pages.begin(), pages.end());
+    }
+    if (ec) return 0;
+
+    uint64_t garbage = 0;
+    std::vector<std::pair<PageHash, PageLocation>> kept;
+    kept.reserve(live.size());
+    for (const auto& entry : index) {
+        if (live.count(entry.first)) {
+            kept.push_back(entry);
+        } else {
+            garbage += RECORD_HEADER_SIZE + entry.second.length;
+        }
+    }
+    if (garbage == 0) return 0;
+
+    // Sweep: copy live pages, in their current order, into a new generation
+    std::sort(kept.begin(), kept.end(), [](const std::pair<PageHash, PageLocation>& a,
+                                           const std::pair<PageHash, PageLocation>& b) {
+        return a.second.offset < b.second.offset;
+    });
+
+    uint64_t newGeneration = generation + 1;
+    std::string newPackPath = packPath + ".tmp";
+    std::string newIndexPath = indexPath + ".tmp";
+    std::ifstream oldPack(packPath, std::ios::binary);
+    FILE* pack = std::fopen(newPackPath.c_str(), "wb");
+    FILE* idx = std::fopen(newIndexPath.c_str(), "wb");
+    bool ok = oldPack && pack && idx &&
+              writeHeader(pack, PACK_MAGIC, newGeneration) &&
+              writeHeader(idx, INDEX_MAGIC, newGeneration);
+
+    std::vector<unsigned char> page(MAX_PAGE_SIZE);
+    uint64_t newPackSize = HEADER_SIZE;
+    for (auto& entry : kept) {
+        if (!ok) break;
+        oldPack.seekg(static_cast<std::streamoff>(entry.second.offset));
+        ok = static_cast<bool>(oldPack.read(reinterpret_cast<char*>(page.data()), entry.second.length)) &&
+             writePackRecord(pack, entry.first, page.data(), entry.second.length);
+        entry.second.offset = newPackSize + RECORD_HEADER_SIZE;
+        newPackSize += RECORD_HEADER_SIZE + entry.second.length;
+        ok = ok && writeIndexRecord(idx, entry.first, entry.second.offset, entry.second.length);
+    }
+    if (pack) ok = std::fclose(pack) == 0 && ok;
+    if (idx) ok = std::fclose(idx) == 0 && ok;
+
+    // Pack first: if the index rename is lost, its old generation no longer
+    // matches and it is rebuilt from the new pack on the next load
+    ok = ok && FileCopy::sync(newPackPath) && FileCopy::sync(newIndexPath) &&
+         FileCopy::replace(newPackPath, packPath) && FileCopy::replace(newIndexPath, indexPath);
+    if (!ok) {
+        std::cerr << "Page store cleanup failed" << std::endl;
+        std::remove(newPackPath.c_str());
+        std::remove(newIndexPath.c_str());
+        loaded = false;
+        index.clear();
+        return 0;
+    }
+
+    index.clear();
+    for (const auto& entry : kept) {
+        index.insert(entry);
+    }
+    generation = newGeneration;
+    packSize = newPackSize;
+    return garbage;
+}
+
+PageStore::Stats PageStore::getStats() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    Stats stats;
+
+    std::error_code ec;
+    for (fs::directory_iterator it(manifestDirectory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (isManifest(it->path().string())) ++stats.manifests;
+    }
+    stats.indexLoaded = loaded;
+    if (loaded) {
+        stats.uniquePages = index.size();
+        stats.packBytes = packSize;
+    } else {
+        uintmax_t size = fs::file_size(packPath, ec);
+        stats.packBytes = ec ? 0 : static_cast<uint64_t>(size);
+    }
+    return stats;
+}
@@ -0,0 +1,90 @@
+#ifndef PAGE_STORE_H
+#define PAGE_STORE_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef _WIN32
+    #include "../thread_compat.h"
+#else
+    #include <mutex>
+#endif
+
+// Content-addressed store for backup pages. Each distinct database page
+// (by SHA-256) is kept once in an append-only pack file, and a backup is a
+// manifest listing the hashes of its pages in order. Successive backups
+// share most of their pages, so each new one costs its changed pages plus
+// 32 bytes of manifest per page.
+//
+// Files in the store directory:
+//   pages.pack                header, then (hash, length, data) records
+//   pages.idx                 header, then (hash, offset, length) records
+//   manifests/<id>.manifest   page size, page count, page hashes
+// Both headers carry a generation that changes whenever the pack is
+// compacted. On load a stale or missing index is rebuilt from the pack, and
+// pack records written after the last index update are indexed again.
+class PageStore {
+public:
+    typedef std::array<unsigned char, 32> PageHash;
+
+    struct Stats {
+        size_t manifests = 0;
+        bool indexLoaded = false;   // uniquePages is only known once it is
+        uint64_t uniquePages = 0;
+        uint64_t packBytes = 0;
+    };
+
+    static const size_t INGEST_BATCH_PAGES = 1024;
+
+private:
+    struct PageHashHasher {
+        size_t operator()(const PageHash& hash) const;
+    };
+
+    struct PageLocation {
+        uint64_t offset;   // of the page data within the pack
+        uint32_t length;
+    };
+
+    std::string directory;
+    std::string packPath;
+    std::string indexPath;
+    std::string manifestDirectory;
+
+    bool loaded;
+    uint64_t generation;
+    uint64_t packSize;
+    std::unordered_map<PageHash, PageLocation, PageHashHasher> index;
+    std::mutex storeMutex;
+
+    bool ensureLoaded();
+    bool createStore();
+    bool loadIndex(uint64_t& indexedEnd);
+    bool indexPackTail(uint64_t from);
+    static bool readManifest(const std::string& path, uint32_t& pageSize, std::vector<PageHash>& pages);
+
+public:
+    explicit PageStore(const std::string& directory);
+
+    static bool isManifest(const std::string& path);
+
+    // Stores the pages of a database file that are not present yet and
+    // writes its manifest; returns the manifest path, or "" on failure
+    std::string ingest(const std::string& databasePath, const std::string& backupId);
+    // Rebuilds the database file a manifest describes
+    bool materialize(const std::string& manifestPath, const std::string& outputPath);
+    // Removes manifests whose backup ID is not in `backupIds` (backups that
+    // were never recorded), then rewrites the pack without pages that no
+    // remaining manifest lists; returns the number of bytes reclaimed
+    uint64_t collectGarbage(const std::unordered_set<std::string>& backupIds);
+    // Counts from what is already in memory and on disk; never loads or
+    // rebuilds the index
+    Stats getStats();
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "ReaderPool.h"
+#include <iostream>
+
+ReaderPool::Lease::Lease(ReaderConnection* connection)
+    : connection(connection) {
+}
+
+ReaderPool::Lease::~Lease() {
+    if (connection) {
+        connection->mutex.unlock();
+    }
+}
+
+ReaderPool::Lease::Lease(Lease&& other) noexcept
+    : connection(other.connection) {
+    other.connection = nullptr;
+}
+
+ReaderPool::ReaderPool() : nextReader(0) {
+}
+
+ReaderPool::~ReaderPool() {
+    close();
+}
+
+bool ReaderPool::open(const std::string& dbPath, size_t count) {
+    // Connections are reopened in place so that concurrent acquire() calls
+    // never see the pool itself change size (e.g. during a restore)
+    if (readers.empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            readers.push_back(std::unique_ptr<ReaderConnection>(new ReaderConnection()));
+        }
+    }
+
+    for (auto& reader : readers) {
+        std::lock_guard<std::mutex> lock(reader->mutex);
+        if (reader->db) {
+            continue;
+        }
+
+        // Each connection is guarded by its own mutex, so SQLite's internal
+        // per-connection mutex is unnecessary
+        int rc = sqlite3_open_v2(dbPath.c_str(), &reader->db,
+                                 SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+        if (rc != SQLITE_OK) {
+            std::cerr << "Cannot open reader connection: " << sqlite3_errmsg(reader->db) << std::endl;
+            sqlite3_close(reader->db);
+            reader->db = nullptr;
+            return false;
+        }
+
+        sqlite3_busy_timeout(reader->db, 5000);
+        reader->statements.reset(reader->db);
+    }
+
+    return true;
+}
+
+void ReaderPool::close() {
+    for (auto& reader : readers) {
+        std::lock_guard<std::mutex> lock(reader->mutex);
+        reader->statements.clear();
+        if (reader->db) {
+            sqlite3_close(reader->db);
+            reader->db = nullptr;
+        }
+    }
+}
+
+ReaderPool::Lease ReaderPool::acquire() const {
+    if (readers.empty()) {
+        return Lease(nullptr);
+    }
+
+    size_t start = nextReader.fetch_add(1, std::memory_order_relaxed) % readers.size();
+
+    // Prefer an idle connection, starting from a rotating offset
+    for (size_t i = 0; i < readers.size(); ++i) {
+        ReaderConnection* reader = readers[(start + i) % readers.size()].get();
+        if (reader->mutex.try_lock()) {
+            return Lease(reader);
+        }
+    }
+
+    // All readers busy: queue on the one we started from
+    ReaderConnection* reader = readers[start].get();
+    reader->mutex.lock();
+    return Lease(reader);
+}
+
+size_t ReaderPool::getStatementCacheHits() const {
+    size_t hits = 0;
+    for (const auto& reader : readers) {
+        std::lock_guard<std::mutex> lock(reader->mutex);
+        hits += reader->statements.getHits();
+    }
+    return hits;
+}
+
+size_t ReaderPool::getStatementCacheMisses() const {
+    size_t misses = 0;
+    for (const auto& reader : readers) {
+        std::lock_guard<std::mutex> lock(reader->mutex);
+        misses += reader->statements.getMisses();
+    }
+    return misses;
+}
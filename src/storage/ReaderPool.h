@@ -0,0 +1,73 @@
+#ifndef READER_POOL_H
+#define READER_POOL_H
+
+#include "StatementCache.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <sqlite3.h>
+
+#ifdef _WIN32
+    #include "../thread_compat.h"
+#else
+    #include <mutex>
+#endif
+
+// One read-only SQLite connection with its own statement cache.
+struct ReaderConnection {
+    sqlite3* db;
+    StatementCache statements;
+    std::mutex mutex;
+
+    ReaderConnection() : db(nullptr) {}
+};
+
+// Fixed-size pool of read-only connections to a WAL database.
+// Each connection is used by one thread at a time; in WAL mode readers never
+// block the writer (or each other), so lookups run in parallel with transfers.
+class ReaderPool {
+public:
+    // Exclusive access to one reader connection, released on destruction
+    class Lease {
+    private:
+        ReaderConnection* connection;
+
+    public:
+        explicit Lease(ReaderConnection* connection);
+        ~Lease();
+        Lease(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        sqlite3* db() const { return connection ? connection->db : nullptr; }
+        StatementCache& statements() const { return connection->statements; }
+        explicit operator bool() const { return connection && connection->db; }
+    };
+
+private:
+    std::vector<std::unique_ptr<ReaderConnection>> readers;
+    mutable std::atomic<size_t> nextReader;
+
+public:
+    ReaderPool();
+    ~ReaderPool();
+
+    ReaderPool(const ReaderPool&) = delete;
+    ReaderPool& operator=(const ReaderPool&) = delete;
+
+    // Opens `count` connections on first use; later calls reopen closed ones
+    bool open(const std::string& dbPath, size_t count);
+    // Closes every connection, waiting for outstanding leases
+    void close();
+
+    // Returns a free reader, or waits on one if all are busy
+    Lease acquire() const;
+
+    size_t size() const { return readers.size(); }
+    size_t getStatementCacheHits() const;
+    size_t getStatementCacheMisses() const;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "StatementCache.h"
+#include <iostream>
+
+StatementCache::StatementCache(sqlite3* db)
+    : db(db), hits(0), misses(0) {
+}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+void StatementCache::reset(sqlite3* newDb) {
+    clear();
+    db = newDb;
+}
+
+sqlite3_stmt* StatementCache::acquire(StatementId id, const char* sql) {
+    auto it = statements.find(id);
+    if (it != statements.end()) {
+        hits++;
+        sqlite3_reset(it->second);
+        sqlite3_clear_bindings(it->second);
+        return it->second;
+    }
+
+    if (!db) {
+        return nullptr;
+    }
+
+    misses++;
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        std::cerr << "Prepare statement error: " << sqlite3_errmsg(db) << std::endl;
+        return nullptr;
+    }
+
+    statements[id] = stmt;
+    return stmt;
+}
+
+void StatementCache::release(sqlite3_stmt* stmt) {
+    if (stmt) {
+        sqlite3_reset(stmt);
+    }
+}
+
+void StatementCache::clear() {
+    for (auto& entry : statements) {
+        sqlite3_finalize(entry.second);
+    }
+    statements.clear();
+}
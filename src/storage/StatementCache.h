@@ -0,0 +1,89 @@
+#ifndef STATEMENT_CACHE_H
+#define STATEMENT_CACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+#include <sqlite3.h>
+
+// Identifies a prepared statement inside a StatementCache.
+// Each ID must always be used with the same SQL text.
+enum class StatementId {
+    BEGIN_TRANSACTION,
+    COMMIT_TRANSACTION,
+    ROLLBACK_TRANSACTION,
+    SAVEPOINT_BEGIN,
+    SAVEPOINT_RELEASE,
+    SAVEPOINT_ROLLBACK,
+    IMPORT_SAVEPOINT_BEGIN,
+    IMPORT_SAVEPOINT_RELEASE,
+    IMPORT_SAVEPOINT_ROLLBACK,
+    LEDGER_SAVEPOINT_BEGIN,
+    LEDGER_SAVEPOINT_RELEASE,
+    LEDGER_SAVEPOINT_ROLLBACK,
+    USER_EXISTS,
+    USER_INSERT,
+    USER_UPDATE,
+    USER_SELECT_BY_USERNAME,
+    USER_SELECT_BY_ID,
+    USER_DELETE,
+    WALLET_INSERT,
+    WALLET_UPSERT,
+    WALLET_UPSERT_KEEP_BALANCE,
+    WALLET_SELECT_BY_ID,
+    WALLET_SELECT_BY_OWNER,
+    WALLET_SCAN_CHUNK,
+    WALLET_BALANCE,
+    WALLET_DEBIT,
+    WALLET_CREDIT,
+    TRANSACTION_INSERT,
+    TRANSACTION_SELECT_BY_WALLET,
+    TRANSACTION_PAGE_BY_WALLET,
+    WALLET_AGGREGATES_SELECT,
+    MASTER_WALLET_ID,
+    OTP_UPSERT,
+    OTP_SELECT,
+    OTP_CONSUME,
+    OTP_DELETE,
+    OTP_DELETE_EXPIRED,
+    SYSTEM_STATS_SELECT,
+    WALLET_COUNT_SELECT,
+    LEDGER_SEQUENCE_UPDATE
+};
+
+// Per-connection cache of prepared statements.
+// Statements are compiled once on first use and handed out reset with
+// cleared bindings afterwards. Not thread-safe: callers must hold the lock
+// of the connection the cache belongs to.
+class StatementCache {
+private:
+    sqlite3* db;
+    std::unordered_map<StatementId, sqlite3_stmt*> statements;
+    size_t hits;
+    size_t misses;
+
+public:
+    explicit StatementCache(sqlite3* db = nullptr);
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    // Finalizes all cached statements and binds the cache to a new connection
+    void reset(sqlite3* newDb);
+
+    // Returns a ready-to-bind statement, compiling `sql` on a cache miss
+    sqlite3_stmt* acquire(StatementId id, const char* sql);
+
+    // Resets a statement so it releases its read/write locks early
+    static void release(sqlite3_stmt* stmt);
+
+    // Finalizes every cached statement (required before sqlite3_close)
+    void clear();
+
+    size_t getHits() const { return hits; }
+    size_t getMisses() const { return misses; }
+    size_t size() const { return statements.size(); }
+};
+
+#endif
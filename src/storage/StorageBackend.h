@@ -0,0 +1,118 @@
+#ifndef STORAGE_BACKEND_H
+#define STORAGE_BACKEND_H
+
+#include "../models/User.h"
+#include "../models/Wallet.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <future>
+#include <cstdint>
+
+// Column projection for StorageBackend::forEachUser. username is always
+// read; fields outside the mask are left empty on the yielded User.
+enum UserColumn : unsigned {
+    USER_COLUMN_ID            = 1u << 0,
+    USER_COLUMN_PASSWORD_HASH = 1u << 1,
+    USER_COLUMN_PROFILE       = 1u << 2,  // full_name, email, phone_number
+    USER_COLUMN_ROLE          = 1u << 3,
+    USER_COLUMN_FLAGS         = 1u << 4,  // is_password_generated, is_first_login
+    USER_COLUMN_WALLET_ID     = 1u << 5,
+    USER_COLUMNS_ALL          = 0x3Fu
+};
+
+// Running totals of the whole store, kept up to date on every write
+struct SystemStats {
+    long long users = 0;
+    long long wallets = 0;
+    long long lockedWallets = 0;
+    long long transactions = 0;
+    double totalPoints = 0.0;
+};
+
+// A user and the wallet created with it, for StorageBackend::importAccounts
+struct NewAccount {
+    User user;  // the wallet's ID is user.getWalletId()
+    double initialBalance;
+};
+
+// Persistence used by AuthSystem, WalletManager and OTPStorage: users,
+// wallets, transactions and OTPs. DatabaseManager is the SQLite backend;
+// InMemoryStorage keeps everything in hash maps for benchmarks, load tests
+// and throwaway environments. Backup and WAL management are not part of
+// this interface and stay on DatabaseManager.
+//
+// Implementations must be safe to call from several threads at once.
+class StorageBackend {
+public:
+    static const size_t DEFAULT_HISTORY_PAGE_SIZE = 50;
+
+    // Visitors for the streaming scans; return false to stop
+    using UserVisitor = std::function<bool(const User&)>;
+    using WalletVisitor = std::function<bool(const Wallet&)>;
+    // Runs once a queued transfer is durable, before its future completes
+    using TransferCallback = std::function<void(const TransferResult&)>;
+
+    virtual ~StorageBackend() = default;
+
+    virtual bool initialize() = 0;
+
+    // Inserts or updates by user_id; usernames must stay unique
+    virtual bool saveUser(const User& user) = 0;
+    bool saveUser(std::shared_ptr<User> user) { return user ? saveUser(*user) : false; }
+    virtual std::unique_ptr<User> loadUserByUsername(const std::string& username) = 0;
+    virtual std::unique_ptr<User> loadUserById(const std::string& userId) = 0;
+    // Visitors may call back into the backend. Returns the number of users visited.
+    virtual size_t forEachUser(const UserVisitor& visitor, unsigned columns = USER_COLUMNS_ALL) = 0;
+    virtual std::vector<std::shared_ptr<User>> loadAllUsers() = 0;
+    // Also removes the user's wallet and OTPs; fails while the wallet has history
+    virtual bool deleteUser(const std::string& userId) = 0;
+    // Creates each user together with its wallet, many per write; an account
+    // goes in whole or not at all. One message per account in input order,
+    // empty if it was created.
+    virtual std::vector<std::string> importAccounts(const std::vector<NewAccount>& accounts) = 0;
+
+    // Inserts or updates by wallet_id; the owner must exist
+    virtual bool saveWallet(const Wallet& wallet) = 0;
+    bool saveWallet(std::shared_ptr<Wallet> wallet) { return wallet ? saveWallet(*wallet) : false; }
+    // Loaded wallets carry their recent history
+    virtual std::shared_ptr<Wallet> loadWallet(const std::string& walletId) = 0;
+    virtual std::shared_ptr<Wallet> loadWalletByOwnerId(const std::string& ownerId) = 0;
+    // Wallets are yielded without history. Returns the number visited.
+    virtual size_t forEachWallet(const WalletVisitor& visitor) = 0;
+
+    // Moves points and records the transfer atomically; returns the new
+    // transaction ID, or an empty string if nothing was changed
+    virtual std::string transferPointsWithId(const std::string& fromWalletId,
+                                             const std::string& toWalletId,
+                                             double amount,
+                                             const std::string& description) = 0;
+    // One result per request in input order; a failing leg leaves no trace
+    // and does not affect the others
+    virtual std::vector<TransferResult> transferPointsBatch(const std::vector<TransferRequest>& requests) = 0;
+    virtual std::future<TransferResult> submitTransfer(const TransferRequest& request,
+                                                       TransferCallback onCommitted = nullptr) = 0;
+
+    // Wallet ID of the first user still marked is_first_login
+    virtual std::string getMasterWalletId() = 0;
+    virtual bool saveTransaction(const Transaction& transaction) = 0;
+    // Up to pageSize transactions older than `cursor`, newest first
+    virtual TransactionPage loadTransactionPage(const std::string& walletId,
+                                                const HistoryCursor& cursor = HistoryCursor(),
+                                                size_t pageSize = DEFAULT_HISTORY_PAGE_SIZE) = 0;
+    virtual WalletFlowSummary loadWalletFlowSummary(const std::string& walletId) = 0;
+    virtual bool loadSystemStats(SystemStats& stats) const = 0;
+
+    // One OTP per user and purpose; times are seconds since epoch
+    virtual bool saveOTP(const std::string& userId, const std::string& purpose,
+                         const std::string& otpCode, int64_t expiresAt) = 0;
+    virtual std::string loadOTP(const std::string& userId, const std::string& purpose, int64_t now) = 0;
+    // Deletes the OTP only if the code matches and has not expired
+    virtual bool consumeOTP(const std::string& userId, const std::string& purpose,
+                            const std::string& otpCode, int64_t now) = 0;
+    virtual void removeOTP(const std::string& userId, const std::string& purpose) = 0;
+    virtual int removeExpiredOTPs(int64_t now) = 0;
+};
+
+#endif
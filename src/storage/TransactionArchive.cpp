@@ -0,0 +1,232 @@
+#include "TransactionArchive.h"
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <cstdio>
+
+namespace fs = std::filesystem;
+
+static const int64_t SECONDS_PER_DAY = 86400;
+
+// Same columns, in the same order, as the hot table so that rows can be
+// copied with SELECT * and read back with the same row reader
+static const char* PARTITION_SCHEMA_SQL = R"(
+    PRAGMA archive.synchronous = FULL;
+    CREATE TABLE IF NOT EXISTS archive.transactions (
+        transaction_id TEXT PRIMARY KEY,
+        from_wallet_id TEXT,
+        to_wallet_id TEXT,
+        amount REAL NOT NULL,
+        description TEXT,
+        transaction_type INTEGER NOT NULL,
+        timestamp INTEGER NOT NULL
+    );
+    CREATE INDEX IF NOT EXISTS archive.idx_transaction_from_cover
+        ON transactions(from_wallet_id, timestamp, transaction_id, to_wallet_id, amount);
+    CREATE INDEX IF NOT EXISTS archive.idx_transaction_to_cover
+        ON transactions(to_wallet_id, timestamp, transaction_id, from_wallet_id, amount);
+)";
+
+// Days since 1970-01-01 of a proleptic Gregorian date, and back
+// (http://howardhinnant.github.io/date_algorithms.html)
+static int64_t daysFromCivil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+static void civilFromDays(int64_t days, int64_t& year, int& month) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    year = yearOfEra + era * 400 + (month <= 2);
+}
+
+static int64_t floorDiv(int64_t value, int64_t divisor) {
+    return value / divisor - (value % divisor != 0 && (value < 0) != (divisor < 0));
+}
+
+static bool execute(sqlite3* db, const char* sql) {
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "Transaction archive error: " << (errMsg ? errMsg : sqlite3_errmsg(db)) << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+TransactionArchive::TransactionArchive(const std::string& directory)
+    : directory(directory) {
+}
+
+int TransactionArchive::archiveOldestMonth(sqlite3* db, int64_t cutoff) {
+    // Scans the hot table; it is kept small, and an index on timestamp alone
+    // would cost every insert to speed up this occasional job
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT MIN(timestamp) FROM main.transactions WHERE timestamp < ?;",
+                           -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Transaction archive error: " << sqlite3_errmsg(db) << std::endl;
+        return -1;
+    }
+    sqlite3_bind_int64(stmt, 1, cutoff);
+    bool found = sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL;
+    int64_t oldest = found ? sqlite3_column_int64(stmt, 0) : 0;
+    sqlite3_finalize(stmt);
+    if (!found) {
+        return 0;
+    }
+
+    int64_t year;
+    int month;
+    civilFromDays(floorDiv(oldest, SECONDS_PER_DAY), year, month);
+    int64_t monthStart = daysFromCivil(year, month, 1) * SECONDS_PER_DAY;
+    int64_t monthEnd = daysFromCivil(month == 12 ? year + 1 : year, month == 12 ? 1 : month + 1, 1) * SECONDS_PER_DAY;
+    int64_t until = std::min(monthEnd, cutoff);
+
+    char monthKey[32];
+    char fileName[64];
+    std::snprintf(monthKey, sizeof(monthKey), "%04lld-%02d", static_cast<long long>(year), month);
+    std::snprintf(fileName, sizeof(fileName), "transactions_%04lld_%02d.db", static_cast<long long>(year), month);
+
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    std::string path = directory + "/" + fileName;
+
+    if (sqlite3_prepare_v2(db, "ATTACH DATABASE ? AS archive;", -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Transaction archive error: " << sqlite3_errmsg(db) << std::endl;
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, path.c_str(), -1, SQLITE_TRANSIENT);
+    bool attached = sqlite3_step(stmt) == SQLITE_DONE;
+    sqlite3_finalize(stmt);
+    if (!attached) {
+        std::cerr << "Cannot attach transaction archive " << path << ": " << sqlite3_errmsg(db) << std::endl;
+        return -1;
+    }
+
+    int moved = -1;
+    int64_t firstTimestamp = 0, lastTimestamp = 0, rows = 0;
+    bool inTransaction = false;
+    do {
+        if (!execute(db, PARTITION_SCHEMA_SQL)) break;
+
+        // Copy first, committed on its own: the partition is durable before
+        // anything leaves the hot table. Copies left by an interrupted run
+        // are replaced.
+        const char* copySql = R"(
+            INSERT OR REPLACE INTO archive.transactions
+            SELECT * FROM main.transactions WHERE timestamp >= ?1 AND timestamp < ?2;
+        )";
+        if (sqlite3_prepare_v2(db, copySql, -1, &stmt, nullptr) != SQLITE_OK) break;
+        sqlite3_bind_int64(stmt, 1, monthStart);
+        sqlite3_bind_int64(stmt, 2, until);
+        bool copied = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+        if (!copied) break;
+
+        const char* rangeSql = "SELECT COUNT(*), MIN(timestamp), MAX(timestamp) FROM archive.transactions;";
+        if (sqlite3_prepare_v2(db, rangeSql, -1, &stmt, nullptr) != SQLITE_OK) break;
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            rows = sqlite3_column_int64(stmt, 0);
+            firstTimestamp = sqlite3_column_int64(stmt, 1);
+            lastTimestamp = sqlite3_column_int64(stmt, 2);
+        }
+        sqlite3_finalize(stmt);
+
+        // The delete and the new watermark commit together in the main file
+        if (!execute(db, "BEGIN IMMEDIATE;")) break;
+        inTransaction = true;
+
+        const char* deleteSql = "DELETE FROM main.transactions WHERE timestamp >= ?1 AND timestamp < ?2;";
+        if (sqlite3_prepare_v2(db, deleteSql, -1, &stmt, nullptr) != SQLITE_OK) break;
+        sqlite3_bind_int64(stmt, 1, monthStart);
+        sqlite3_bind_int64(stmt, 2, until);
+        bool deleted = sqlite3_step(stmt) == SQLITE_DONE;
+        int deletedRows = sqlite3_changes(db);
+        sqlite3_finalize(stmt);
+        if (!deleted) break;
+
+        const char* registerSql = R"(
+            INSERT INTO main.archive_partitions
+                (month, file_name, first_timestamp, last_timestamp, row_count, archived_until)
+            VALUES (?1, ?2, ?3, ?4, ?5, ?6)
+            ON CONFLICT (month) DO UPDATE SET
+                first_timestamp = excluded.first_timestamp,
+                last_timestamp = excluded.last_timestamp,
+                row_count = excluded.row_count,
+                archived_until = MAX(archived_until, excluded.archived_until);
+        )";
+        if (sqlite3_prepare_v2(db, registerSql, -1, &stmt, nullptr) != SQLITE_OK) break;
+        sqlite3_bind_text(stmt, 1, monthKey, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, fileName, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 3, firstTimestamp);
+        sqlite3_bind_int64(stmt, 4, lastTimestamp);
+        sqlite3_bind_int64(stmt, 5, rows);
+        sqlite3_bind_int64(stmt, 6, until);
+        bool registered = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_finalize(stmt);
+        if (!registered) break;
+
+        if (!execute(db, "COMMIT;")) break;
+        inTransaction = false;
+        moved = deletedRows;
+    } while (false);
+
+    if (moved < 0) {
+        std::cerr << "Cannot archive transactions of " << monthKey << ": " << sqlite3_errmsg(db) << std::endl;
+    }
+    if (inTransaction) {
+        execute(db, "ROLLBACK;");
+    }
+    execute(db, "DETACH DATABASE archive;");
+    return moved;
+}
+
+bool TransactionArchive::loadPartitions(sqlite3* db, std::vector<Partition>& partitions,
+                                        int64_t& watermark) const {
+    partitions.clear();
+    watermark = 0;
+
+    const char* sql = R"(
+        SELECT month, file_name, first_timestamp, last_timestamp, row_count, archived_until
+        FROM archive_partitions ORDER BY month DESC;
+    )";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "Cannot read archive partitions: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        Partition partition;
+        partition.month = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        partition.path = directory + "/" + reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        partition.firstTimestamp = sqlite3_column_int64(stmt, 2);
+        partition.lastTimestamp = sqlite3_column_int64(stmt, 3);
+        partition.rows = sqlite3_column_int64(stmt, 4);
+        watermark = std::max<int64_t>(watermark, sqlite3_column_int64(stmt, 5));
+        partitions.push_back(partition);
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+}
+
+sqlite3* TransactionArchive::openPartition(const Partition& partition) {
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(partition.path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        std::cerr << "Cannot open transaction archive " << partition.path << ": "
+                  << (db ? sqlite3_errmsg(db) : "out of memory") << std::endl;
+        sqlite3_close(db);
+        return nullptr;
+    }
+    return db;
+}
@@ -0,0 +1,55 @@
+#ifndef TRANSACTION_ARCHIVE_H
+#define TRANSACTION_ARCHIVE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <sqlite3.h>
+
+// Cold storage for old transactions, one SQLite file per UTC month.
+// Archiving copies the hot rows older than a cutoff into their month's file
+// and then deletes them from the main database, so the hot table and its
+// covering indexes only hold recent history.
+//
+// The main database lists the partitions in archive_partitions. The largest
+// archived_until there is the watermark: every transaction older than it
+// has been archived, and archives are only ever read below it. A partition
+// is written and synced before its rows leave the hot table, so a crash in
+// between leaves copies above the watermark, which readers ignore and the
+// next run overwrites.
+//
+// Files in the archive directory:
+//   transactions_<yyyy>_<mm>.db   same columns and covering indexes as the
+//                                 hot table, without foreign keys
+class TransactionArchive {
+public:
+    static const int DEFAULT_HOT_DAYS = 90;
+
+    struct Partition {
+        std::string month;        // "yyyy-mm"
+        std::string path;
+        int64_t firstTimestamp;
+        int64_t lastTimestamp;
+        int64_t rows;
+    };
+
+private:
+    std::string directory;
+
+public:
+    explicit TransactionArchive(const std::string& directory);
+
+    // Moves the hot rows of the oldest month holding any row older than
+    // `cutoff` (seconds since epoch), up to the cutoff. Returns the number
+    // of rows moved, 0 when none are left, or -1 on error. Needs the writer
+    // connection exclusively and outside a transaction.
+    int archiveOldestMonth(sqlite3* db, int64_t cutoff);
+
+    // Reads the partitions, newest first, and the watermark (0 if none)
+    bool loadPartitions(sqlite3* db, std::vector<Partition>& partitions, int64_t& watermark) const;
+
+    // Opens a partition read-only; the caller closes it
+    static sqlite3* openPartition(const Partition& partition);
+};
+
+#endif
@@ -0,0 +1,236 @@
+#include "TransactionExporter.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <charconv>
+
+// Column positions in the transactions table
+enum TransactionColumn {
+    COLUMN_ID,
+    COLUMN_FROM,
+    COLUMN_TO,
+    COLUMN_AMOUNT,
+    COLUMN_DESCRIPTION,
+    COLUMN_TYPE,
+    COLUMN_TIMESTAMP
+};
+
+TransactionExporter::TransactionExporter(const std::string& path, ExportFormat format)
+    : path(path), format(format), file(nullptr), used(0), rows(0), failed(false) {
+}
+
+TransactionExporter::~TransactionExporter() {
+    if (file) close();
+}
+
+bool TransactionExporter::open() {
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Cannot create export file: " << path << std::endl;
+        return false;
+    }
+    buffer.resize(size_t(BUFFER_SIZE));
+    used = 0;
+    rows = 0;
+    failed = false;
+
+    if (format == ExportFormat::CSV) {
+        static const char header[] =
+            "transaction_id,from_wallet_id,to_wallet_id,amount,type,description,timestamp\n";
+        append(header, sizeof(header) - 1);
+    }
+    return !failed;
+}
+
+bool TransactionExporter::flush() {
+    if (failed) return false;
+    if (used > 0 && std::fwrite(buffer.data(), 1, used, file) != used) {
+        std::cerr << "Cannot write export file: " << path << std::endl;
+        failed = true;
+        return false;
+    }
+    used = 0;
+    return true;
+}
+
+void TransactionExporter::append(const char* data, size_t length) {
+    while (length > 0) {
+        if (used == buffer.size() && !flush()) return;
+        size_t chunk = std::min(length, buffer.size() - used);
+        std::memcpy(buffer.data() + used, data, chunk);
+        used += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void TransactionExporter::appendId(sqlite3_stmt* stmt, int column) {
+    if (sqlite3_column_type(stmt, column) == SQLITE_BLOB && sqlite3_column_bytes(stmt, column) == 16) {
+        static const char digits[] = "0123456789abcdef";
+        const unsigned char* bytes = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, column));
+        char text[36];
+        size_t pos = 0;
+        for (int i = 0; i < 16; ++i) {
+            if (i == 4 || i == 6 || i == 8 || i == 10) text[pos++] = '-';
+            text[pos++] = digits[bytes[i] >> 4];
+            text[pos++] = digits[bytes[i] & 0x0F];
+        }
+        append(text, sizeof(text));
+        return;
+    }
+    // TEXT IDs (older files, "SYSTEM") need no escaping
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    append(text ? text : "", static_cast<size_t>(sqlite3_column_bytes(stmt, column)));
+}
+
+void TransactionExporter::appendJsonId(sqlite3_stmt* stmt, int column) {
+    if (sqlite3_column_type(stmt, column) == SQLITE_NULL) {
+        append("null", 4);
+        return;
+    }
+    append('"');
+    appendId(stmt, column);
+    append('"');
+}
+
+void TransactionExporter::appendInteger(int64_t value) {
+    char text[24];
+    auto result = std::to_chars(text, text + sizeof(text), value);
+    append(text, static_cast<size_t>(result.ptr - text));
+}
+
+void TransactionExporter::appendDouble(double value) {
+    // Shortest text that reads back as the same double
+    char text[32];
+    auto result = std::to_chars(text, text + sizeof(text), value);
+    append(text, static_cast<size_t>(result.ptr - text));
+}
+
+void TransactionExporter::appendCsvText(const char* text, size_t length) {
+    bool quote = false;
+    for (size_t i = 0; i < length && !quote; ++i) {
+        char c = text[i];
+        quote = c == ',' || c == '"' || c == '\n' || c == '\r';
+    }
+    if (!quote) {
+        append(text, length);
+        return;
+    }
+
+    append('"');
+    size_t start = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (text[i] == '"') {
+            append(text + start, i + 1 - start);
+            append('"');
+            start = i + 1;
+        }
+    }
+    append(text + start, length - start);
+    append('"');
+}
+
+void TransactionExporter::appendJsonText(const char* text, size_t length) {
+    static const char digits[] = "0123456789abcdef";
+    append('"');
+    size_t start = 0;
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        append(text + start, i - start);
+        start = i + 1;
+        switch (c) {
+            case '"':  append("\\\"", 2); break;
+            case '\\': append("\\\\", 2); break;
+            case '\n': append("\\n", 2); break;
+            case '\r': append("\\r", 2); break;
+            case '\t': append("\\t", 2); break;
+            default: {
+                char escape[6] = {'\\', 'u', '0', '0', digits[c >> 4], digits[c & 0x0F]};
+                append(escape, sizeof(escape));
+                break;
+            }
+        }
+    }
+    append(text + start, length - start);
+    append('"');
+}
+
+void TransactionExporter::appendRow(sqlite3_stmt* stmt) {
+    const char* description = reinterpret_cast<const char*>(sqlite3_column_text(stmt, COLUMN_DESCRIPTION));
+    size_t descriptionLength = static_cast<size_t>(sqlite3_column_bytes(stmt, COLUMN_DESCRIPTION));
+    if (!description) description = "";
+
+    if (format == ExportFormat::CSV) {
+        appendId(stmt, COLUMN_ID);
+        append(',');
+        appendId(stmt, COLUMN_FROM);
+        append(',');
+        appendId(stmt, COLUMN_TO);
+        append(',');
+        appendDouble(sqlite3_column_double(stmt, COLUMN_AMOUNT));
+        append(',');
+        appendInteger(sqlite3_column_int(stmt, COLUMN_TYPE));
+        append(',');
+        appendCsvText(description, descriptionLength);
+        append(',');
+        appendInteger(sqlite3_column_int64(stmt, COLUMN_TIMESTAMP));
+        append('\n');
+        return;
+    }
+
+    // IDs are UUIDs or plain words, so they are quoted without escaping
+    static const char transactionKey[] = "{\"transactionId\":\"";
+    static const char fromKey[] = "\",\"fromWalletId\":";
+    static const char toKey[] = ",\"toWalletId\":";
+    static const char amountKey[] = ",\"amount\":";
+    static const char typeKey[] = ",\"type\":";
+    static const char descriptionKey[] = ",\"description\":";
+    static const char timestampKey[] = ",\"timestamp\":";
+
+    append(transactionKey, sizeof(transactionKey) - 1);
+    appendId(stmt, COLUMN_ID);
+    append(fromKey, sizeof(fromKey) - 1);
+    appendJsonId(stmt, COLUMN_FROM);
+    append(toKey, sizeof(toKey) - 1);
+    appendJsonId(stmt, COLUMN_TO);
+    append(amountKey, sizeof(amountKey) - 1);
+    appendDouble(sqlite3_column_double(stmt, COLUMN_AMOUNT));
+    append(typeKey, sizeof(typeKey) - 1);
+    appendInteger(sqlite3_column_int(stmt, COLUMN_TYPE));
+    append(descriptionKey, sizeof(descriptionKey) - 1);
+    appendJsonText(description, descriptionLength);
+    append(timestampKey, sizeof(timestampKey) - 1);
+    appendInteger(sqlite3_column_int64(stmt, COLUMN_TIMESTAMP));
+    append("}\n", 2);
+}
+
+bool TransactionExporter::writeRows(sqlite3_stmt* stmt) {
+    if (!file || failed) return false;
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        appendRow(stmt);
+        if (failed) return false;
+        ++rows;
+    }
+    if (rc != SQLITE_DONE) {
+        std::cerr << "Export query failed: " << sqlite3_errmsg(sqlite3_db_handle(stmt)) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TransactionExporter::close() {
+    if (!file) return false;
+    bool success = flush();
+    if (std::fclose(file) != 0) {
+        std::cerr << "Cannot close export file: " << path << std::endl;
+        success = false;
+    }
+    file = nullptr;
+    buffer.clear();
+    buffer.shrink_to_fit();
+    return success;
+}
@@ -0,0 +1,80 @@
+#ifndef TRANSACTION_EXPORTER_H
+#define TRANSACTION_EXPORTER_H
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <sqlite3.h>
+
+enum class ExportFormat {
+    CSV,     // header row, then one row per transaction
+    NDJSON   // one JSON object per line, keys as in Transaction::toJson
+};
+
+// Which transactions DatabaseManager::exportTransactions writes; times are
+// seconds since epoch
+struct TransactionExportFilter {
+    std::string walletId;                                   // empty: every wallet
+    int64_t from = 0;                                       // inclusive
+    int64_t until = std::numeric_limits<int64_t>::max();    // exclusive
+};
+
+// Writes transaction rows to a file straight from SQLite statements. Each
+// column is formatted from the pointer SQLite returns into one large
+// buffer that goes out with a single fwrite when full, so nothing is
+// allocated per row and the export runs at the speed of the disk.
+//
+// Statements must select the transactions columns in table order
+// (SELECT * FROM transactions). IDs are written in their string form
+// whether stored as TEXT or as 16-byte BLOBs.
+class TransactionExporter {
+public:
+    static const size_t BUFFER_SIZE = 4 * 1024 * 1024;
+
+private:
+    std::string path;
+    ExportFormat format;
+    FILE* file;
+    std::vector<char> buffer;
+    size_t used;
+    int64_t rows;
+    bool failed;
+
+    bool flush();
+    void append(const char* data, size_t length);
+    void append(char c) {
+        if (used == buffer.size() && !flush()) return;
+        buffer[used++] = c;
+    }
+    void appendId(sqlite3_stmt* stmt, int column);
+    // Quoted, or null for a NULL column
+    void appendJsonId(sqlite3_stmt* stmt, int column);
+    void appendInteger(int64_t value);
+    void appendDouble(double value);
+    // Quoted only when it holds a separator, quote or line break
+    void appendCsvText(const char* text, size_t length);
+    void appendJsonText(const char* text, size_t length);
+    void appendRow(sqlite3_stmt* stmt);
+
+public:
+    TransactionExporter(const std::string& path, ExportFormat format);
+    // Closes the file if close() was not called, keeping what was written
+    ~TransactionExporter();
+
+    TransactionExporter(const TransactionExporter&) = delete;
+    TransactionExporter& operator=(const TransactionExporter&) = delete;
+
+    // Creates (or truncates) the file and writes the CSV header
+    bool open();
+    // Writes every row the statement yields; false on a read or write error
+    bool writeRows(sqlite3_stmt* stmt);
+    // Flushes and closes; false if anything failed along the way
+    bool close();
+
+    int64_t getRowCount() const { return rows; }
+};
+
+#endif
@@ -0,0 +1,282 @@
+#include "TransferLedger.h"
+#include "../security/SecurityUtils.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+TransferLedger::TransferLedger(const std::string& path, BalanceLoader loadBalance,
+                               Materializer materialize)
+    : journal(path), loadBalance(loadBalance), materialize(materialize),
+      journaledSequence(0), appliedSequence(0), failing(false), stopping(false) {
+}
+
+TransferLedger::~TransferLedger() {
+    close();
+}
+
+bool TransferLedger::open(uint64_t databaseSequence) {
+    std::lock_guard<std::mutex> lock(appendMutex);
+
+    std::vector<LedgerEntry> entries;
+    if (!journal.open(entries)) {
+        return false;
+    }
+
+    // Transfers acknowledged before a crash or shutdown that never reached
+    // the database; they are applied before anything new is accepted
+    std::vector<LedgerEntry> unapplied;
+    for (const auto& entry : entries) {
+        if (entry.sequence > databaseSequence) {
+            unapplied.push_back(entry);
+        }
+    }
+    for (size_t start = 0; start < unapplied.size(); start += MATERIALIZE_BATCH_SIZE) {
+        size_t end = std::min(unapplied.size(), start + MATERIALIZE_BATCH_SIZE);
+        std::vector<LedgerEntry> batch(unapplied.begin() + start, unapplied.begin() + end);
+        if (!materialize(batch)) {
+            std::cerr << "Cannot apply journaled transfers to the database" << std::endl;
+            journal.close();
+            return false;
+        }
+    }
+    if (!unapplied.empty()) {
+        databaseSequence = unapplied.back().sequence;
+        std::cout << "Applied " << unapplied.size() << " journaled transfers" << std::endl;
+    }
+
+    // Numbers must keep rising past what the database has seen, even if
+    // the journal file was lost
+    if (journal.getNextSequence() <= databaseSequence && !journal.reset(databaseSequence + 1)) {
+        journal.close();
+        return false;
+    }
+
+    balances.clear();
+    {
+        std::lock_guard<std::mutex> queueLock(queueMutex);
+        pending.clear();
+        journaledSequence = databaseSequence;
+        appliedSequence = databaseSequence;
+        failing = false;
+        stopping = false;
+    }
+    worker = std::thread(&TransferLedger::run, this);
+    return true;
+}
+
+void TransferLedger::close() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(appendMutex);
+    journal.close();
+}
+
+void TransferLedger::run() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        queueReady.wait(lock, [this] { return stopping || !pending.empty(); });
+        // Drain the queue before honouring stop
+        if (pending.empty()) return;
+
+        size_t count = std::min(pending.size(), size_t(MATERIALIZE_BATCH_SIZE));
+        std::vector<LedgerEntry> batch(pending.begin(), pending.begin() + count);
+
+        lock.unlock();
+        bool applied = materialize(batch);
+        lock.lock();
+
+        if (applied) {
+            pending.erase(pending.begin(), pending.begin() + count);
+            appliedSequence = batch.back().sequence;
+            failing = false;
+            queueDrained.notify_all();
+            continue;
+        }
+
+        // The entries stay queued, and in the journal, which is applied on
+        // the next start if the database never comes back
+        failing = true;
+        queueDrained.notify_all();
+        if (stopping) {
+            std::cerr << "Journaled transfers left for the next start: " << pending.size() << std::endl;
+            return;
+        }
+        queueReady.wait_for(lock, std::chrono::milliseconds(MATERIALIZE_RETRY_DELAY_MS),
+                            [this] { return stopping; });
+    }
+}
+
+bool TransferLedger::drain() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    uint64_t target = journaledSequence;
+    queueDrained.wait(lock, [this, target] { return appliedSequence >= target || failing; });
+    return appliedSequence >= target;
+}
+
+bool TransferLedger::currentBalance(const std::string& walletId,
+                                    const std::unordered_map<std::string, double>& group,
+                                    double& balance) {
+    auto changed = group.find(walletId);
+    if (changed != group.end()) {
+        balance = changed->second;
+        return true;
+    }
+    auto cached = balances.find(walletId);
+    if (cached != balances.end()) {
+        balance = cached->second;
+        return true;
+    }
+    // A wallet that is not cached has no transfers waiting to be applied,
+    // so the database value is current
+    if (!loadBalance(walletId, balance)) {
+        return false;
+    }
+    balances.emplace(walletId, balance);
+    return true;
+}
+
+std::vector<TransferResult> TransferLedger::append(const std::vector<TransferRequest>& requests) {
+    std::vector<TransferResult> results(requests.size(), TransferResult{false, "", "", 0.0});
+    if (requests.empty()) {
+        return results;
+    }
+
+    std::lock_guard<std::mutex> lock(appendMutex);
+
+    if (journal.size() >= COMPACT_THRESHOLD_RECORDS &&
+        getAppliedSequence() + 1 == journal.getNextSequence()) {
+        journal.reset(journal.getNextSequence());
+    }
+
+    // Balances after the legs accepted so far; cached only once durable
+    std::unordered_map<std::string, double> group;
+    std::vector<LedgerEntry> entries;
+    std::vector<size_t> legs;
+    int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const TransferRequest& request = requests[i];
+        TransferResult& result = results[i];
+
+        if (request.amount <= 0) {
+            result.message = "Amount must be positive";
+            continue;
+        }
+
+        double fromBalance = 0.0;
+        if (!currentBalance(request.fromWalletId, group, fromBalance)) {
+            result.message = "Source wallet not found";
+            continue;
+        }
+        if (fromBalance < request.amount) {
+            result.message = "Insufficient balance";
+            continue;
+        }
+
+        double toBalance = 0.0;
+        if (!currentBalance(request.toWalletId, group, toBalance)) {
+            result.message = "Destination wallet not found";
+            continue;
+        }
+
+        LedgerEntry entry;
+        entry.timestamp = now;
+        entry.amount = request.amount;
+        entry.transactionId = SecurityUtils::generateUUID();
+        entry.fromWalletId = request.fromWalletId;
+        entry.toWalletId = request.toWalletId;
+        entry.description = request.description;
+        if (!journal.append(entry)) {
+            result.message = LedgerJournal::canEncode(entry) ? "Cannot write to the ledger journal"
+                                                             : "Wallet ID cannot be journaled";
+            continue;
+        }
+
+        // A self-transfer credits the balance it was just debited from
+        group[request.fromWalletId] = fromBalance - request.amount;
+        double toBefore = request.toWalletId == request.fromWalletId ? fromBalance - request.amount
+                                                                     : toBalance;
+        group[request.toWalletId] = toBefore + request.amount;
+
+        result.success = true;
+        result.message = "Transfer completed";
+        result.transactionId = entry.transactionId;
+        result.newBalance = fromBalance - request.amount;
+        entries.push_back(entry);
+        legs.push_back(i);
+    }
+
+    if (entries.empty()) {
+        return results;
+    }
+
+    // One flush for the whole group
+    if (!journal.sync()) {
+        journal.discardUnsynced();
+        for (size_t i : legs) {
+            results[i] = TransferResult{false, "Cannot write to the ledger journal", "", 0.0};
+        }
+        return results;
+    }
+
+    for (const auto& change : group) {
+        balances[change.first] = change.second;
+    }
+    {
+        std::lock_guard<std::mutex> queueLock(queueMutex);
+        pending.insert(pending.end(), entries.begin(), entries.end());
+        journaledSequence = entries.back().sequence;
+    }
+    queueReady.notify_one();
+    return results;
+}
+
+bool TransferLedger::flush() {
+    return drain();
+}
+
+bool TransferLedger::rebase(const std::function<bool()>& replaceDatabase) {
+    std::lock_guard<std::mutex> lock(appendMutex);
+
+    if (!drain()) {
+        std::cerr << "Journaled transfers are not yet in the database; try again later" << std::endl;
+        return false;
+    }
+
+    // Whatever is put in place may hold other balances and an older
+    // sequence number, so nothing journaled so far may be applied to it.
+    // Everything is in the current file by now, so the journal is emptied
+    // before the swap: a crash after the swap must not replay old records
+    uint64_t nextSequence = journal.getNextSequence();
+    if (!journal.reset(nextSequence)) {
+        std::cerr << "Cannot empty the ledger journal; database left as it is" << std::endl;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> queueLock(queueMutex);
+        journaledSequence = nextSequence - 1;
+        appliedSequence = nextSequence - 1;
+    }
+
+    bool replaced = replaceDatabase();
+    balances.clear();
+    return replaced;
+}
+
+uint64_t TransferLedger::getAppliedSequence() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return appliedSequence;
+}
+
+size_t TransferLedger::getJournalSize() {
+    std::lock_guard<std::mutex> lock(appendMutex);
+    return journal.size();
+}
@@ -0,0 +1,98 @@
+#ifndef TRANSFER_LEDGER_H
+#define TRANSFER_LEDGER_H
+
+#include "LedgerJournal.h"
+#include "../models/Wallet.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+// Ledger mode for transfers: the journal, not the wallets table, is the
+// source of truth. A group of transfers is checked against balances held
+// in memory, appended to the LedgerJournal and flushed once; callers are
+// answered as soon as that flush returns. A background thread then applies
+// the journaled transfers to the database in batches ("materializes"
+// them), so balances and history in SQLite trail the journal slightly.
+//
+// Balances are read from the database the first time a wallet is used and
+// kept from then on, which is only correct while nothing else changes
+// them: with a ledger attached every transfer must go through append().
+class TransferLedger {
+public:
+    // Reads a wallet's balance from the database; false if there is no such wallet
+    using BalanceLoader = std::function<bool(const std::string& walletId, double& balance)>;
+    // Applies the entries to the database and records the last sequence
+    // number, all in one transaction; false leaves them queued for a retry
+    using Materializer = std::function<bool(const std::vector<LedgerEntry>& entries)>;
+
+    static const size_t MATERIALIZE_BATCH_SIZE = 1024;
+    // Once the database has caught up, a journal this long starts over
+    static const size_t COMPACT_THRESHOLD_RECORDS = 64 * 1024;  // 16 MiB
+    static const int MATERIALIZE_RETRY_DELAY_MS = 500;
+
+private:
+    LedgerJournal journal;
+    BalanceLoader loadBalance;
+    Materializer materialize;
+
+    // Held for a whole group, and by rebase(); guards journal and balances
+    std::mutex appendMutex;
+    std::unordered_map<std::string, double> balances;
+
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::condition_variable queueDrained;
+    std::deque<LedgerEntry> pending;  // journaled, not yet in the database
+    uint64_t journaledSequence;
+    uint64_t appliedSequence;
+    bool failing;  // the last materialization failed; retried later
+    bool stopping;
+    std::thread worker;
+
+    void run();
+    // Waits until everything journaled so far is in the database; false
+    // if materialization is failing
+    bool drain();
+    // Balance including the earlier legs of the current group; loads and
+    // caches the database value on first use
+    bool currentBalance(const std::string& walletId,
+                        const std::unordered_map<std::string, double>& group, double& balance);
+
+public:
+    TransferLedger(const std::string& path, BalanceLoader loadBalance, Materializer materialize);
+    ~TransferLedger();
+
+    TransferLedger(const TransferLedger&) = delete;
+    TransferLedger& operator=(const TransferLedger&) = delete;
+
+    // Opens the journal, applies every entry after `databaseSequence` (the
+    // last one the database has) before returning, then starts the thread
+    bool open(uint64_t databaseSequence);
+    // Applies what is still queued, then stops the thread
+    void close();
+
+    // Same checks and messages as DatabaseManager's SQL transfers, legs in
+    // order. Results are final once this returns: successful legs are on
+    // disk in the journal.
+    std::vector<TransferResult> append(const std::vector<TransferRequest>& requests);
+
+    // Blocks until the database has every transfer journaled before the
+    // call; false if applying them is failing
+    bool flush();
+    // For replacing the database file (restore): holds back new transfers,
+    // lets the database catch up, empties the journal, runs
+    // `replaceDatabase` and drops the cached balances. Fails without
+    // touching the database if the journal cannot be emptied
+    bool rebase(const std::function<bool()>& replaceDatabase);
+
+    uint64_t getAppliedSequence();
+    size_t getJournalSize();
+};
+
+#endif
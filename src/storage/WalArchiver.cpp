@@ -0,0 +1,465 @@
+#include "WalArchiver.h"
+#include "FileCopy.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// WAL file layout (https://www.sqlite.org/fileformat2.html#walformat)
+static const size_t WAL_HEADER_SIZE = 32;
+static const size_t WAL_FRAME_HEADER_SIZE = 24;
+static const uint32_t WAL_MAGIC = 0x377f0682;   // low bit: big-endian checksums
+
+// Segment layout: SEGMENT_MAGIC, u32 page size, then one record per commit:
+// i64 commit time (ms), u32 database size in pages, u32 page count, and
+// `page count` times (u32 page number, page data). All little-endian.
+static const char SEGMENT_MAGIC[8] = {'W', 'A', 'L', 'S', 'E', 'G', '0', '1'};
+static const size_t COMMIT_HEADER_SIZE = 16;
+
+static uint32_t readBigEndian32(const unsigned char* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+static uint32_t readLittleEndian32(const unsigned char* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+static void appendLittleEndian(std::vector<unsigned char>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+// SQLite's running WAL checksum over 8-byte blocks
+static void walChecksum(bool bigEndian, const unsigned char* data, size_t size,
+                        uint32_t& s1, uint32_t& s2) {
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        uint32_t x0 = bigEndian ? readBigEndian32(data + i) : readLittleEndian32(data + i);
+        uint32_t x1 = bigEndian ? readBigEndian32(data + i + 4) : readLittleEndian32(data + i + 4);
+        s1 += x0 + s2;
+        s2 += x1 + s1;
+    }
+}
+
+static int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Flushes a finished file to disk before it is renamed into place
+static bool syncFile(FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+WalArchiver::WalArchiver(const std::string& dbPath, const std::string& directory)
+    : dbPath(dbPath),
+      walPath(dbPath + "-wal"),
+      directory(directory),
+      scanned(false),
+      nextSequence(1),
+      timeline(1) {
+    resetWalPosition();
+}
+
+void WalArchiver::resetWalPosition() {
+    walSalt1 = 0;
+    walSalt2 = 0;
+    archivedFrames = 0;
+    walChecksum1 = 0;
+    walChecksum2 = 0;
+    commitMarks.clear();
+}
+
+void WalArchiver::recordCommit(int walFrames) {
+    commitMarks.push_back(CommitMark{static_cast<uint32_t>(walFrames), nowMs()});
+}
+
+bool WalArchiver::needsArchive(int walFrames) const {
+    if (walFrames >= ARCHIVE_THRESHOLD_FRAMES) return true;
+    return !commitMarks.empty() &&
+           nowMs() - commitMarks.front().timeMs >= MAX_ARCHIVE_DELAY_SECONDS * 1000LL;
+}
+
+void WalArchiver::ensureScanned() {
+    if (scanned) return;
+    scanned = true;
+
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+
+    for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        const std::string name = it->path().filename().string();
+        unsigned long long sequence = 0;
+        unsigned int fileTimeline = 0;
+        long long timeMs = 0;
+        int consumed = 0;
+
+        if (std::sscanf(name.c_str(), "base_%llu_%u_%lld.db%n",
+                        &sequence, &fileTimeline, &timeMs, &consumed) == 3 &&
+            consumed == static_cast<int>(name.size())) {
+            bases.push_back(BaseSnapshot{sequence, fileTimeline, timeMs, it->path().string()});
+            nextSequence = std::max<uint64_t>(nextSequence, sequence);
+        } else if (std::sscanf(name.c_str(), "segment_%llu_%u.walseg%n",
+                               &sequence, &fileTimeline, &consumed) == 2 &&
+                   consumed == static_cast<int>(name.size())) {
+            segments.push_back(Segment{sequence, fileTimeline, it->path().string()});
+            nextSequence = std::max<uint64_t>(nextSequence, sequence + 1);
+        }
+    }
+
+    std::sort(bases.begin(), bases.end(), [](const BaseSnapshot& a, const BaseSnapshot& b) {
+        return a.sequence != b.sequence ? a.sequence < b.sequence : a.timeMs < b.timeMs;
+    });
+    std::sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) {
+        return a.sequence < b.sequence;
+    });
+
+    // New segments continue the timeline of the most recent base
+    if (!bases.empty()) {
+        timeline = bases.back().timeline;
+    }
+}
+
+bool WalArchiver::archive(sqlite3* db, int checkpointMode) {
+    ensureScanned();
+
+    // Frames reach the database file only after they are safely archived
+    if (!archiveNewFrames()) {
+        return false;
+    }
+
+    int walFrames = 0;
+    int checkpointedFrames = 0;
+    int rc = sqlite3_wal_checkpoint_v2(db, nullptr, checkpointMode, &walFrames, &checkpointedFrames);
+
+    if (checkpointMode == SQLITE_CHECKPOINT_TRUNCATE) {
+        if (rc != SQLITE_OK) {
+            std::cerr << "WAL checkpoint could not complete: " << sqlite3_errstr(rc) << std::endl;
+            return false;
+        }
+        resetWalPosition();
+    }
+
+    // A passive checkpoint blocked by readers simply continues next time
+    return rc == SQLITE_OK || rc == SQLITE_BUSY;
+}
+
+bool WalArchiver::archiveNewFrames() {
+    std::ifstream wal(walPath, std::ios::binary);
+    if (!wal) return true;  // no WAL yet
+
+    unsigned char header[WAL_HEADER_SIZE];
+    if (!wal.read(reinterpret_cast<char*>(header), WAL_HEADER_SIZE)) {
+        return true;  // truncated by the last checkpoint and not written since
+    }
+
+    uint32_t magic = readBigEndian32(header);
+    if ((magic & ~1u) != WAL_MAGIC) {
+        return true;
+    }
+    bool bigEndian = (magic & 1u) != 0;
+    uint32_t pageSize = readBigEndian32(header + 8);
+    uint32_t salt1 = readBigEndian32(header + 16);
+    uint32_t salt2 = readBigEndian32(header + 20);
+
+    // New salts mean SQLite restarted the WAL after a full checkpoint, which
+    // only ever follows an archive: start over at the first frame
+    if (archivedFrames == 0 || salt1 != walSalt1 || salt2 != walSalt2) {
+        uint32_t s1 = 0, s2 = 0;
+        walChecksum(bigEndian, header, 24, s1, s2);
+        if (s1 != readBigEndian32(header + 24) || s2 != readBigEndian32(header + 28)) {
+            return true;  // header not valid, so no frame is either
+        }
+        walSalt1 = salt1;
+        walSalt2 = salt2;
+        archivedFrames = 0;
+        walChecksum1 = s1;
+        walChecksum2 = s2;
+    }
+
+    const size_t frameSize = WAL_FRAME_HEADER_SIZE + pageSize;
+    wal.seekg(static_cast<std::streamoff>(WAL_HEADER_SIZE + archivedFrames * frameSize));
+
+    std::vector<unsigned char> frame(frameSize);
+    std::vector<unsigned char> pending;   // pages of the commit being read
+    uint32_t pendingPages = 0;
+    std::vector<unsigned char> record;
+    uint32_t s1 = walChecksum1, s2 = walChecksum2;
+    uint32_t frameIndex = archivedFrames;
+
+    FILE* out = nullptr;
+    std::string segmentPath;
+    std::string partialPath;
+    uint32_t lastCommittedFrame = archivedFrames;
+    uint32_t committedChecksum1 = s1, committedChecksum2 = s2;
+    bool ok = true;
+
+    while (wal.read(reinterpret_cast<char*>(frame.data()), frameSize)) {
+        const unsigned char* frameHeader = frame.data();
+        if (readBigEndian32(frameHeader + 8) != walSalt1 || readBigEndian32(frameHeader + 12) != walSalt2) {
+            break;  // left over from an earlier WAL generation
+        }
+        walChecksum(bigEndian, frameHeader, 8, s1, s2);
+        walChecksum(bigEndian, frameHeader + WAL_FRAME_HEADER_SIZE, pageSize, s1, s2);
+        if (s1 != readBigEndian32(frameHeader + 16) || s2 != readBigEndian32(frameHeader + 20)) {
+            break;
+        }
+        ++frameIndex;
+
+        appendLittleEndian(pending, readBigEndian32(frameHeader), 4);
+        pending.insert(pending.end(), frameHeader + WAL_FRAME_HEADER_SIZE, frameHeader + frameSize);
+        ++pendingPages;
+
+        uint32_t databasePages = readBigEndian32(frameHeader + 4);
+        if (databasePages == 0) continue;   // not the last frame of a commit
+
+        // Commit times come from the WAL hook; commits made before this
+        // process started have none and are stamped with the archive time
+        auto mark = std::lower_bound(commitMarks.begin(), commitMarks.end(), frameIndex,
+            [](const CommitMark& m, uint32_t frameNumber) { return m.frame < frameNumber; });
+        int64_t commitTime = mark != commitMarks.end() ? mark->timeMs : nowMs();
+
+        if (!out) {
+            segmentPath = directory + "/segment_";
+            char name[64];
+            std::snprintf(name, sizeof(name), "%010llu_%u.walseg",
+                          static_cast<unsigned long long>(nextSequence), timeline);
+            segmentPath += name;
+            partialPath = segmentPath + ".part";
+            out = std::fopen(partialPath.c_str(), "wb");
+            if (!out) {
+                std::cerr << "Cannot create WAL segment: " << partialPath << std::endl;
+                return false;
+            }
+            record.assign(SEGMENT_MAGIC, SEGMENT_MAGIC + sizeof(SEGMENT_MAGIC));
+            appendLittleEndian(record, pageSize, 4);
+            ok = std::fwrite(record.data(), 1, record.size(), out) == record.size();
+        }
+
+        record.clear();
+        appendLittleEndian(record, static_cast<uint64_t>(commitTime), 8);
+        appendLittleEndian(record, databasePages, 4);
+        appendLittleEndian(record, pendingPages, 4);
+        ok = ok && std::fwrite(record.data(), 1, record.size(), out) == record.size()
+                && std::fwrite(pending.data(), 1, pending.size(), out) == pending.size();
+        if (!ok) break;
+
+        pending.clear();
+        pendingPages = 0;
+        lastCommittedFrame = frameIndex;
+        committedChecksum1 = s1;
+        committedChecksum2 = s2;
+    }
+
+    if (!out) return true;   // nothing committed since the last archive
+
+    ok = syncFile(out) && ok;
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok || std::rename(partialPath.c_str(), segmentPath.c_str()) != 0) {
+        std::cerr << "Cannot write WAL segment: " << segmentPath << std::endl;
+        std::remove(partialPath.c_str());
+        return false;
+    }
+
+    segments.push_back(Segment{nextSequence, timeline, segmentPath});
+    ++nextSequence;
+
+    archivedFrames = lastCommittedFrame;
+    walChecksum1 = committedChecksum1;
+    walChecksum2 = committedChecksum2;
+    commitMarks.erase(commitMarks.begin(),
+        std::upper_bound(commitMarks.begin(), commitMarks.end(), lastCommittedFrame,
+            [](uint32_t frameNumber, const CommitMark& m) { return frameNumber < m.frame; }));
+    return true;
+}
+
+bool WalArchiver::createBaseSnapshot(bool newTimeline) {
+    ensureScanned();
+
+    uint32_t baseTimeline = timeline;
+    if (newTimeline) {
+        for (const auto& base : bases) {
+            baseTimeline = std::max(baseTimeline, base.timeline);
+        }
+        ++baseTimeline;
+    }
+
+    BaseSnapshot base;
+    base.sequence = nextSequence;
+    base.timeline = baseTimeline;
+    base.timeMs = nowMs();
+
+    char name[96];
+    std::snprintf(name, sizeof(name), "/base_%010llu_%u_%lld.db",
+                  static_cast<unsigned long long>(base.sequence), base.timeline,
+                  static_cast<long long>(base.timeMs));
+    base.path = directory + name;
+    std::string partialPath = base.path + ".part";
+
+    bool ok = FileCopy::copy(dbPath, partialPath) && FileCopy::sync(partialPath);
+    if (!ok || !FileCopy::replace(partialPath, base.path)) {
+        std::cerr << "Cannot write base snapshot: " << base.path << std::endl;
+        std::remove(partialPath.c_str());
+        return false;
+    }
+
+    bases.push_back(base);
+    timeline = baseTimeline;
+    return true;
+}
+
+bool WalArchiver::needsBaseSnapshot() {
+    ensureScanned();
+    if (bases.empty()) return true;
+
+    const BaseSnapshot& latest = bases.back();
+    uintmax_t replayBytes = 0;
+    for (const auto& segment : segments) {
+        std::error_code ec;
+        uintmax_t size = fs::file_size(segment.path, ec);
+        if (!ec && segment.timeline == latest.timeline && segment.sequence >= latest.sequence) {
+            replayBytes += size;
+        }
+    }
+    std::error_code ec;
+    uintmax_t databaseBytes = fs::file_size(dbPath, ec);
+    return !ec && replayBytes >= databaseBytes;
+}
+
+std::chrono::system_clock::time_point WalArchiver::getEarliestRecoveryPoint() {
+    ensureScanned();
+    if (bases.empty()) return std::chrono::system_clock::time_point();
+
+    int64_t earliest = bases.front().timeMs;
+    for (const auto& base : bases) {
+        earliest = std::min(earliest, base.timeMs);
+    }
+    return std::chrono::system_clock::time_point(std::chrono::milliseconds(earliest));
+}
+
+bool WalArchiver::materialize(const std::chrono::system_clock::time_point& target,
+                              const std::string& outputPath) {
+    ensureScanned();
+    int64_t targetMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        target.time_since_epoch()).count();
+
+    // The most recent base taken at or before the target; a later base on
+    // another timeline wins over an older one since it supersedes it
+    const BaseSnapshot* base = nullptr;
+    for (const auto& candidate : bases) {
+        if (candidate.timeMs <= targetMs) base = &candidate;
+    }
+    if (!base) {
+        std::cerr << "No base snapshot at or before the requested time" << std::endl;
+        return false;
+    }
+
+    if (!FileCopy::copy(base->path, outputPath)) {
+        std::cerr << "Cannot copy base snapshot: " << base->path << std::endl;
+        return false;
+    }
+
+    std::fstream output(outputPath, std::ios::binary | std::ios::in | std::ios::out);
+    uint32_t pageSize = 0;
+    uint64_t databasePages = 0;
+    bool reachedTarget = false;
+
+    for (const auto& segment : segments) {
+        if (segment.timeline != base->timeline || segment.sequence < base->sequence) continue;
+        if (!applySegment(segment, targetMs, output, pageSize, databasePages, reachedTarget)) {
+            std::cerr << "Cannot replay WAL segment: " << segment.path << std::endl;
+            return false;
+        }
+        if (reachedTarget) break;
+    }
+
+    if (!output.flush()) return false;
+    output.close();
+
+    // Commits may have shrunk the file (e.g. VACUUM); size follows the last one
+    if (databasePages > 0) {
+        std::error_code ec;
+        fs::resize_file(outputPath, databasePages * pageSize, ec);
+        if (ec) return false;
+    }
+    return true;
+}
+
+bool WalArchiver::applySegment(const Segment& segment, int64_t targetMs, std::fstream& output,
+                               uint32_t& pageSize, uint64_t& databasePages, bool& reachedTarget) {
+    std::ifstream in(segment.path, std::ios::binary);
+    unsigned char header[sizeof(SEGMENT_MAGIC) + 4];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        std::memcmp(header, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0) {
+        return false;
+    }
+    pageSize = readLittleEndian32(header + sizeof(SEGMENT_MAGIC));
+    std::vector<char> page(pageSize);
+
+    unsigned char commitHeader[COMMIT_HEADER_SIZE];
+    while (in.read(reinterpret_cast<char*>(commitHeader), COMMIT_HEADER_SIZE)) {
+        int64_t commitTime = static_cast<int64_t>(readLittleEndian32(commitHeader) |
+                                                  (uint64_t(readLittleEndian32(commitHeader + 4)) << 32));
+        uint32_t commitPages = readLittleEndian32(commitHeader + 8);
+        uint32_t pageCount = readLittleEndian32(commitHeader + 12);
+
+        // Stop at the first later commit so the result is a prefix of history
+        if (commitTime > targetMs) {
+            reachedTarget = true;
+            return true;
+        }
+
+        for (uint32_t i = 0; i < pageCount; ++i) {
+            unsigned char pageNumber[4];
+            if (!in.read(reinterpret_cast<char*>(pageNumber), 4) || !in.read(page.data(), pageSize)) {
+                return false;
+            }
+            output.seekp(static_cast<std::streamoff>(readLittleEndian32(pageNumber) - 1) * pageSize);
+            if (!output.write(page.data(), pageSize)) return false;
+        }
+        databasePages = commitPages;
+    }
+
+    return in.eof() && in.gcount() == 0;
+}
+
+int WalArchiver::prune(size_t keepCount) {
+    ensureScanned();
+    if (bases.size() <= keepCount) return 0;
+
+    int deleted = 0;
+    std::vector<BaseSnapshot> kept(bases.end() - keepCount, bases.end());
+    for (auto it = bases.begin(); it != bases.end() - keepCount; ++it) {
+        if (std::remove(it->path.c_str()) == 0) ++deleted;
+    }
+    bases = kept;
+
+    // A segment is still needed if some kept base on its timeline precedes it
+    std::vector<Segment> needed;
+    for (const auto& segment : segments) {
+        bool replayable = std::any_of(bases.begin(), bases.end(), [&segment](const BaseSnapshot& base) {
+            return base.timeline == segment.timeline && base.sequence <= segment.sequence;
+        });
+        if (replayable) {
+            needed.push_back(segment);
+        } else if (std::remove(segment.path.c_str()) == 0) {
+            ++deleted;
+        }
+    }
+    segments = needed;
+    return deleted;
+}
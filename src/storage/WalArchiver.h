@@ -0,0 +1,106 @@
+#ifndef WAL_ARCHIVER_H
+#define WAL_ARCHIVER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <sqlite3.h>
+
+// Continuous archiving of the writer connection's WAL for point-in-time
+// recovery. SQLite's automatic checkpoint is replaced by archive(): the
+// committed frames not archived yet are copied to a segment file together
+// with their commit times, and only then checkpointed into the database
+// file. A base snapshot is a plain copy of the database file taken right
+// after a full checkpoint; replaying the following segments over it page by
+// page rebuilds the database as it was after any archived commit.
+//
+// Files in the archive directory:
+//   base_<seq>_<timeline>_<ms>.db    state before segment <seq>
+//   segment_<seq>_<timeline>.walseg  committed pages in commit order
+// Restoring starts a new timeline, so replay from an older base never mixes
+// in history that the restore discarded.
+//
+// Not thread-safe. recordCommit() and needsArchive() only touch commit
+// bookkeeping and need the writer connection held exclusively; every other
+// call must be serialized by the owner, and archive() needs both.
+class WalArchiver {
+public:
+    static const int ARCHIVE_THRESHOLD_FRAMES = 1000;  // SQLite's auto-checkpoint default
+    static const int MAX_ARCHIVE_DELAY_SECONDS = 60;
+    static const size_t MAX_BASE_SNAPSHOTS = 3;
+
+private:
+    struct CommitMark {
+        uint32_t frame;   // WAL frame count right after the commit
+        int64_t timeMs;
+    };
+
+    struct BaseSnapshot {
+        uint64_t sequence;
+        uint32_t timeline;
+        int64_t timeMs;
+        std::string path;
+    };
+
+    struct Segment {
+        uint64_t sequence;
+        uint32_t timeline;
+        std::string path;
+    };
+
+    std::string dbPath;
+    std::string walPath;
+    std::string directory;
+
+    bool scanned;
+    uint64_t nextSequence;
+    uint32_t timeline;
+    std::vector<BaseSnapshot> bases;   // ascending (sequence, time)
+    std::vector<Segment> segments;     // ascending sequence
+
+    // Archive position in the current WAL generation
+    uint32_t walSalt1;
+    uint32_t walSalt2;
+    uint32_t archivedFrames;
+    uint32_t walChecksum1;
+    uint32_t walChecksum2;
+    std::vector<CommitMark> commitMarks;
+
+    void ensureScanned();
+    bool archiveNewFrames();
+    bool applySegment(const Segment& segment, int64_t targetMs, std::fstream& output,
+                      uint32_t& pageSize, uint64_t& databasePages, bool& reachedTarget);
+
+public:
+    WalArchiver(const std::string& dbPath, const std::string& directory);
+
+    // Called from the WAL hook after each commit with the WAL frame count
+    void recordCommit(int walFrames);
+    bool needsArchive(int walFrames) const;
+    // Forgets the archive position; call after the database file is replaced
+    void resetWalPosition();
+
+    // Copies newly committed frames into a segment, then checkpoints with
+    // `checkpointMode`. Returns false if the copy fails, or if a TRUNCATE
+    // checkpoint could not reset the WAL.
+    bool archive(sqlite3* db, int checkpointMode = SQLITE_CHECKPOINT_PASSIVE);
+
+    // Copies the database file as the base for the segments that follow.
+    // The WAL must have just been reset (archive() with TRUNCATE, or the file
+    // just reopened), and no checkpoint may run until this returns.
+    bool createBaseSnapshot(bool newTimeline);
+    // True when there is no base yet, or replaying the segments since the
+    // latest one would read more than copying the database again
+    bool needsBaseSnapshot();
+    std::chrono::system_clock::time_point getEarliestRecoveryPoint();
+
+    // Writes the database as of the last commit at or before `target`
+    bool materialize(const std::chrono::system_clock::time_point& target,
+                     const std::string& outputPath);
+    // Keeps the newest keepCount bases and the segments they can replay
+    int prune(size_t keepCount = MAX_BASE_SNAPSHOTS);
+};
+
+#endif
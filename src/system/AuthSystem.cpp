@@ -1,13 +1,17 @@
 #include "AuthSystem.h"
 #include "../security/OTPManager.h"
 #include "WalletManager.h"
+#include "../storage/OTPStorage.h"
 #include <iostream>
 #include <algorithm>
 #include <regex>
 
-AuthSystem::AuthSystem() 
-    : currentUser(nullptr), isInitialized(false) {
-    dataManager = std::make_shared<DatabaseManager>();
+AuthSystem::AuthSystem()
+    : AuthSystem(std::make_shared<DatabaseManager>()) {
+}
+
+AuthSystem::AuthSystem(std::shared_ptr<StorageBackend> storage)
+    : dataManager(storage), currentUser(nullptr), isInitialized(false) {
     otpManager = std::make_shared<OTPManager>();
     walletManager = std::make_shared<WalletManager>(dataManager, otpManager);
 }
@@ -15,19 +19,28 @@ AuthSystem::~AuthSystem() {
     if (isLoggedIn()) {
         logout();
     }
+    if (maintenance) {
+        maintenance->stop();
+    }
 }
 
 bool AuthSystem::initialize() {
     try {
         if (!dataManager->initialize()) {
-            std::cerr << "Error: Cannot initialize DatabaseManager" << std::endl;
+            std::cerr << "Error: Cannot initialize storage" << std::endl;
             return false;
         }
+        OTPStorage::attach(dataManager);
 
         if (!walletManager->initialize()) {
             std::cerr << "Error: Cannot initialize WalletManager" << std::endl;
             return false;
         }
+
+        if (auto database = getDataManager()) {
+            maintenance = std::make_unique<MaintenanceScheduler>(database);
+            maintenance->start();
+        }
         isInitialized = true;
         return true;
     }
@@ -161,6 +174,18 @@ RegistrationResult AuthSystem::createAccount(const std::string& username,
     return result;
 }
 
+BulkLoadReport AuthSystem::importAccounts(const std::string& path) {
+    if (!isCurrentUserAdmin() && hasAnyAdmin()) {
+        BulkLoadReport report;
+        report.message = "No permission to create accounts!";
+        return report;
+    }
+
+    // Wallets get the same starting points as createAccount gives them
+    BulkLoader loader(dataManager, WalletManager::INITIAL_USER_POINTS);
+    return loader.loadFile(path);
+}
+
 LoginResult AuthSystem::login(const std::string& username, const std::string& password) {
     LoginResult result;
     result.success = false;    if (username.empty() || password.empty()) {
@@ -337,13 +362,12 @@ bool AuthSystem::isCurrentUserAdmin() const {
 
 bool AuthSystem::hasAnyAdmin() const {
     try {
-        auto users = dataManager->loadAllUsers();
-        for (const auto& user : users) {
-            if (user->getRole() == UserRole::ADMIN) {
-                return true;
-            }
-        }
-        return false;
+        bool found = false;
+        dataManager->forEachUser([&found](const User& user) {
+            found = user.getRole() == UserRole::ADMIN;
+            return !found;
+        }, USER_COLUMN_ROLE);
+        return found;
     }
     catch (const std::exception& e) {
         std::cerr << "Error checking for admin users: " << e.what() << std::endl;
@@ -7,6 +7,8 @@
 #include "../security/OTPManager.h"  
 #include "../storage/DatabaseManager.h"
 #include "WalletManager.h"
+#include "MaintenanceScheduler.h"
+#include "BulkLoader.h"
 #include <memory>
 #include <unordered_map>
 #include <string>
@@ -26,16 +28,21 @@ struct RegistrationResult {
 
 class AuthSystem {
 private:
-    std::shared_ptr<DatabaseManager> dataManager;
+    std::shared_ptr<StorageBackend> dataManager;
     std::shared_ptr<OTPManager> otpManager;
     std::shared_ptr<WalletManager> walletManager;
+    std::unique_ptr<MaintenanceScheduler> maintenance;
     std::shared_ptr<User> currentUser;
     std::unordered_map<std::string, std::shared_ptr<User>> userCache;
     
     bool isInitialized;
 
 public:
+    // Stores everything in the SQLite database under ./data
     AuthSystem();
+    // Runs on the given backend, e.g. an InMemoryStorage for load tests;
+    // background maintenance only applies to a DatabaseManager
+    explicit AuthSystem(std::shared_ptr<StorageBackend> storage);
     ~AuthSystem();
     bool initialize();
 
@@ -51,6 +58,8 @@ public:
                                     const std::string& phoneNumber,
                                     UserRole role = UserRole::REGULAR,
                                     bool autoGeneratePassword = true);
+    // Creates every account listed in a CSV or NDJSON file (see BulkLoader)
+    BulkLoadReport importAccounts(const std::string& path);
 
     LoginResult login(const std::string& username, const std::string& password);
     void logout();
@@ -78,7 +87,11 @@ public:
     bool isCurrentUserAdmin() const;
     bool hasAnyAdmin() const;
     std::vector<std::shared_ptr<User>> getAllUsers();
-    std::shared_ptr<DatabaseManager> getDataManager() const { return dataManager; }
+    std::shared_ptr<StorageBackend> getStorage() const { return dataManager; }
+    // The SQLite backend for backup and recovery; nullptr on any other backend
+    std::shared_ptr<DatabaseManager> getDataManager() const {
+        return std::dynamic_pointer_cast<DatabaseManager>(dataManager);
+    }
     
     std::shared_ptr<User> findUserByUsername(const std::string& username);
     std::shared_ptr<User> findUserById(const std::string& userId);
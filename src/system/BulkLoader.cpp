@@ -0,0 +1,432 @@
+#include "BulkLoader.h"
+#include "../security/SecurityUtils.h"
+#include "../ui/UserValidator.h"
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cstdint>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* const FIELD_NAMES[] = {"username", "full_name", "email", "phone_number", "role", "password"};
+const size_t FIELD_COUNT = sizeof(FIELD_NAMES) / sizeof(FIELD_NAMES[0]);
+const size_t REQUIRED_FIELD_COUNT = 4;
+const size_t PASSWORD_FIELD = 5;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) return "";
+    size_t last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+
+std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+// One line of RFC 4180 CSV; quoted fields may not span lines
+bool splitCsvLine(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string field;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quoted) {
+            if (c != '"') {
+                field += c;
+            } else if (i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.push_back(field);
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.push_back(field);
+    return !quoted;
+}
+
+void skipSpace(const std::string& text, size_t& pos) {
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+}
+
+bool parseHex4(const std::string& text, size_t pos, uint32_t& value) {
+    if (pos + 4 > text.size()) return false;
+    value = 0;
+    for (size_t i = pos; i < pos + 4; ++i) {
+        char c = text[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= c - '0';
+        else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+        else return false;
+    }
+    return true;
+}
+
+void appendUtf8(std::string& out, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+// `pos` is on the opening quote; leaves it after the closing one
+bool parseJsonString(const std::string& text, size_t& pos, std::string& out) {
+    out.clear();
+    ++pos;
+    while (pos < text.size()) {
+        char c = text[pos++];
+        if (c == '"') return true;
+        if (static_cast<unsigned char>(c) < 0x20) return false;
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (pos >= text.size()) return false;
+        char escape = text[pos++];
+        switch (escape) {
+            case '"': case '\\': case '/': out += escape; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t codePoint;
+                if (!parseHex4(text, pos, codePoint)) return false;
+                pos += 4;
+                // A high surrogate must be followed by its low half
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    uint32_t low;
+                    if (pos + 6 > text.size() || text[pos] != '\\' || text[pos + 1] != 'u' ||
+                        !parseHex4(text, pos + 2, low) || low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    pos += 6;
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                    return false;
+                }
+                appendUtf8(out, codePoint);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+// A flat JSON object: strings are unescaped, other scalars kept as written
+// (null becomes empty); nested objects and arrays are rejected
+bool parseJsonObject(const std::string& text, std::unordered_map<std::string, std::string>& fields) {
+    fields.clear();
+    size_t pos = 0;
+    skipSpace(text, pos);
+    if (pos >= text.size() || text[pos++] != '{') return false;
+    skipSpace(text, pos);
+    if (pos < text.size() && text[pos] == '}') {
+        ++pos;
+    } else {
+        while (true) {
+            std::string key;
+            std::string value;
+            skipSpace(text, pos);
+            if (pos >= text.size() || text[pos] != '"' || !parseJsonString(text, pos, key)) return false;
+            skipSpace(text, pos);
+            if (pos >= text.size() || text[pos++] != ':') return false;
+            skipSpace(text, pos);
+            if (pos >= text.size()) return false;
+            if (text[pos] == '"') {
+                if (!parseJsonString(text, pos, value)) return false;
+            } else {
+                size_t start = pos;
+                while (pos < text.size() && text[pos] != ',' && text[pos] != '}' &&
+                       !std::isspace(static_cast<unsigned char>(text[pos]))) {
+                    if (text[pos] == '{' || text[pos] == '[' || text[pos] == '"') return false;
+                    ++pos;
+                }
+                if (pos == start) return false;
+                value = text.substr(start, pos - start);
+                if (value == "null") value.clear();
+            }
+            fields[key] = value;
+            skipSpace(text, pos);
+            if (pos >= text.size()) return false;
+            char separator = text[pos++];
+            if (separator == '}') break;
+            if (separator != ',') return false;
+        }
+    }
+    skipSpace(text, pos);
+    return pos == text.size();
+}
+
+}  // namespace
+
+BulkLoader::BulkLoader(std::shared_ptr<StorageBackend> storage, double initialBalance,
+                       size_t threadCount)
+    : storage(storage), threadCount(threadCount), initialBalance(initialBalance) {
+    if (this->threadCount == 0) {
+        this->threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+BulkLoadReport BulkLoader::loadFile(const std::string& path, Format format) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        BulkLoadReport report;
+        report.message = "Cannot open file: " + path;
+        return report;
+    }
+
+    if (format == Format::AUTO) {
+        size_t dot = path.find_last_of('.');
+        std::string extension = dot == std::string::npos ? "" : lowercase(path.substr(dot));
+        if (extension == ".csv") {
+            format = Format::CSV;
+        } else if (extension == ".ndjson" || extension == ".jsonl") {
+            format = Format::NDJSON;
+        }
+    }
+    return load(input, format);
+}
+
+BulkLoadReport BulkLoader::load(std::istream& input, Format format) {
+    BulkLoadReport report;
+    Clock::time_point started = Clock::now();
+    Clock::time_point parseStarted = started;
+
+    // Skip a UTF-8 byte order mark, then tell the formats apart by the first character
+    if (input.peek() == 0xEF) {
+        char bom[3];
+        input.read(bom, 3);
+    }
+    if (format == Format::AUTO) {
+        format = input.peek() == '{' ? Format::NDJSON : Format::CSV;
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+
+    // CSV columns are found by name in the header
+    std::vector<long> columns(FIELD_COUNT, -1);
+    std::vector<std::string> cells;
+    if (format == Format::CSV) {
+        if (!std::getline(input, line)) {
+            report.message = "The file is empty";
+            return report;
+        }
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        splitCsvLine(line, cells);
+        for (size_t i = 0; i < cells.size(); ++i) {
+            std::string name = lowercase(trim(cells[i]));
+            for (size_t field = 0; field < FIELD_COUNT; ++field) {
+                if (name == FIELD_NAMES[field]) columns[field] = static_cast<long>(i);
+            }
+        }
+        for (size_t field = 0; field < REQUIRED_FIELD_COUNT; ++field) {
+            if (columns[field] < 0) {
+                report.message = std::string("Missing column: ") + FIELD_NAMES[field];
+                return report;
+            }
+        }
+    }
+
+    std::vector<Row> rows;
+    rows.reserve(CHUNK_SIZE);
+    std::unordered_map<std::string, std::string> object;
+    std::vector<std::string> values(FIELD_COUNT);
+
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (trim(line).empty()) continue;
+        ++report.rowsRead;
+
+        bool parsed;
+        if (format == Format::CSV) {
+            parsed = splitCsvLine(line, cells);
+            for (size_t field = 0; field < FIELD_COUNT; ++field) {
+                long column = columns[field];
+                values[field] = column >= 0 && static_cast<size_t>(column) < cells.size()
+                                ? cells[column] : "";
+            }
+        } else {
+            parsed = parseJsonObject(line, object);
+            for (size_t field = 0; field < FIELD_COUNT; ++field) {
+                auto it = object.find(FIELD_NAMES[field]);
+                values[field] = it != object.end() ? it->second : "";
+            }
+        }
+        if (!parsed) {
+            report.rejected.push_back({lineNumber, "", "Malformed row"});
+            continue;
+        }
+
+        // Passwords are taken exactly as given
+        for (size_t field = 0; field < FIELD_COUNT; ++field) {
+            if (field != PASSWORD_FIELD) values[field] = trim(values[field]);
+        }
+        rows.push_back(Row{lineNumber, values[0], values[1], values[2], values[3], values[4], values[5]});
+
+        if (rows.size() == CHUNK_SIZE) {
+            report.parseSeconds += secondsSince(parseStarted);
+            importChunk(rows, report);
+            rows.clear();
+            parseStarted = Clock::now();
+        }
+    }
+    report.parseSeconds += secondsSince(parseStarted);
+    if (!rows.empty()) {
+        importChunk(rows, report);
+    }
+
+    std::sort(report.rejected.begin(), report.rejected.end(),
+              [](const BulkLoadIssue& a, const BulkLoadIssue& b) { return a.line < b.line; });
+    report.totalSeconds = secondsSince(started);
+
+    if (input.bad()) {
+        report.message = "Read error after line " + std::to_string(lineNumber);
+        return report;
+    }
+    report.success = true;
+    report.message = "Imported " + std::to_string(report.accountsCreated) + " of " +
+                     std::to_string(report.rowsRead) + " accounts";
+    return report;
+}
+
+std::string BulkLoader::validate(const Row& row, bool passwordGenerated, UserRole& role) {
+    if (!UserValidator::isValidUsername(row.username)) {
+        return "Invalid username! Must be 3-20 characters.";
+    }
+    if (!UserValidator::isValidFullName(row.fullName)) {
+        return "Invalid full name!";
+    }
+    if (!UserValidator::isValidEmail(row.email)) {
+        return "Invalid email format!";
+    }
+    if (!UserValidator::isValidPhoneNumber(row.phoneNumber)) {
+        return "Invalid phone number format!";
+    }
+
+    std::string roleName = lowercase(row.role);
+    if (roleName.empty() || roleName == "user" || roleName == "regular") {
+        role = UserRole::REGULAR;
+    } else if (roleName == "admin") {
+        role = UserRole::ADMIN;
+    } else {
+        return "Unknown role: " + row.role;
+    }
+
+    return passwordGenerated ? "" : UserValidator::validateStrongPassword(row.password);
+}
+
+void BulkLoader::importChunk(std::vector<Row>& rows, BulkLoadReport& report) {
+    Clock::time_point prepareStarted = Clock::now();
+
+    // SecurityUtils draws IDs, salts and passwords from one unsynchronized
+    // generator, so they are drawn here; the pool only validates and hashes
+    std::vector<std::string> userIds(rows.size());
+    std::vector<std::string> walletIds(rows.size());
+    std::vector<std::string> salts(rows.size());
+    std::vector<char> generated(rows.size(), 0);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (rows[i].password.empty()) {
+            rows[i].password = SecurityUtils::generateRandomString(12);
+            generated[i] = 1;
+        }
+        userIds[i] = SecurityUtils::generateUUID();
+        walletIds[i] = SecurityUtils::generateUUID();
+        salts[i] = SecurityUtils::generateSalt();
+    }
+
+    std::vector<NewAccount> accounts(rows.size());
+    std::vector<std::string> errors(rows.size());
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        for (size_t i = next++; i < rows.size(); i = next++) {
+            const Row& row = rows[i];
+            UserRole role = UserRole::REGULAR;
+            errors[i] = validate(row, generated[i] != 0, role);
+            if (!errors[i].empty()) continue;
+
+            User user(userIds[i], row.username, SecurityUtils::hashPassword(row.password, salts[i]),
+                      row.fullName, row.email, row.phoneNumber, role);
+            user.setWalletId(walletIds[i]);
+            user.setRequirePasswordChange(true);
+            accounts[i] = NewAccount{std::move(user), initialBalance};
+        }
+    };
+    std::vector<std::thread> workers;
+    size_t helpers = std::min(threadCount, rows.size()) - 1;
+    for (size_t i = 0; i < helpers; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::vector<NewAccount> valid;
+    std::vector<size_t> validRows;
+    valid.reserve(rows.size());
+    validRows.reserve(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (errors[i].empty()) {
+            valid.push_back(std::move(accounts[i]));
+            validRows.push_back(i);
+        } else {
+            report.rejected.push_back({rows[i].line, rows[i].username, errors[i]});
+        }
+    }
+    report.prepareSeconds += secondsSince(prepareStarted);
+
+    Clock::time_point insertStarted = Clock::now();
+    std::vector<std::string> messages = storage->importAccounts(valid);
+    report.insertSeconds += secondsSince(insertStarted);
+
+    for (size_t k = 0; k < validRows.size(); ++k) {
+        const Row& row = rows[validRows[k]];
+        if (!messages[k].empty()) {
+            report.rejected.push_back({row.line, row.username, messages[k]});
+            continue;
+        }
+        ++report.accountsCreated;
+        if (generated[validRows[k]]) {
+            report.generatedPasswords.emplace_back(row.username, row.password);
+        }
+    }
+}
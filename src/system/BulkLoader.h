@@ -0,0 +1,82 @@
+#ifndef BULK_LOADER_H
+#define BULK_LOADER_H
+
+#include "../storage/StorageBackend.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <istream>
+#include <utility>
+
+// A row that was not imported
+struct BulkLoadIssue {
+    size_t line;  // 1-based line in the input
+    std::string username;
+    std::string message;
+};
+
+struct BulkLoadReport {
+    bool success = false;  // false only if the input could not be read at all
+    std::string message;
+    size_t rowsRead = 0;
+    size_t accountsCreated = 0;
+    std::vector<BulkLoadIssue> rejected;
+    // (username, password) for accounts whose row had no password
+    std::vector<std::pair<std::string, std::string>> generatedPasswords;
+    // Wall-clock time per stage, in seconds
+    double parseSeconds = 0.0;
+    double prepareSeconds = 0.0;  // validation and password hashing
+    double insertSeconds = 0.0;
+    double totalSeconds = 0.0;
+
+    double accountsPerSecond() const {
+        return totalSeconds > 0.0 ? accountsCreated / totalSeconds : 0.0;
+    }
+};
+
+// Onboards user lists of any size: the bulk counterpart of
+// AuthSystem::createAccount. Rows are read CHUNK_SIZE at a time; each chunk
+// is validated and its passwords hashed on a pool of threads, then handed
+// to StorageBackend::importAccounts, which writes it in one transaction.
+//
+// Input is CSV with a header row, or NDJSON with one flat object per line.
+// Fields: username, full_name, email, phone_number (required), role
+// ("admin" or "user", default user) and password (optional). Rows without
+// a password get a generated one, returned in the report. Every account
+// must change its password on first login, as with createAccount.
+class BulkLoader {
+public:
+    enum class Format { AUTO, CSV, NDJSON };
+
+    static const size_t CHUNK_SIZE = 20000;
+
+private:
+    struct Row {
+        size_t line;
+        std::string username;
+        std::string fullName;
+        std::string email;
+        std::string phoneNumber;
+        std::string role;
+        std::string password;
+    };
+
+    std::shared_ptr<StorageBackend> storage;
+    size_t threadCount;
+    double initialBalance;
+
+    // Same rules as the account forms; returns the error, empty if valid
+    static std::string validate(const Row& row, bool passwordGenerated, UserRole& role);
+    // Validates, hashes and inserts one chunk, adding the outcome to `report`
+    void importChunk(std::vector<Row>& rows, BulkLoadReport& report);
+
+public:
+    // threadCount 0 uses one thread per hardware core
+    BulkLoader(std::shared_ptr<StorageBackend> storage, double initialBalance,
+               size_t threadCount = 0);
+
+    BulkLoadReport loadFile(const std::string& path, Format format = Format::AUTO);
+    BulkLoadReport load(std::istream& input, Format format);
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "MaintenanceScheduler.h"
+#include "../security/SecurityUtils.h"
+#include <iostream>
+#include <algorithm>
+
+MaintenanceScheduler::MaintenanceScheduler(std::shared_ptr<DatabaseManager> dataManager)
+    : dataManager(dataManager), stopping(false), walCheckpointDue(false) {
+    using namespace std::chrono;
+
+    tasks = {
+        {"WAL checkpoint", seconds(WAL_CHECK_INTERVAL_SECONDS), {},
+         [this] { return this->dataManager->checkpointWal(); }},
+        {"OTP cleanup", seconds(OTP_CLEANUP_INTERVAL_SECONDS), {},
+         [] { SecurityUtils::cleanupExpiredOTP(); return true; }},
+        {"automatic backup", minutes(BACKUP_CHECK_INTERVAL_MINUTES), {},
+         [this] { return runAutoBackup(); }},
+        {"base snapshot", minutes(BASE_SNAPSHOT_INTERVAL_MINUTES), {},
+         [this] { return this->dataManager->createBaseSnapshot(); }},
+        {"transaction archive", hours(TRANSACTION_ARCHIVE_INTERVAL_HOURS), {},
+         [this] {
+             // Off until an admin sets how much history stays in the main file
+             int hotDays = this->dataManager->getArchiveHotDays();
+             return hotDays <= 0 || this->dataManager->archiveOldTransactions(hotDays) >= 0;
+         }},
+        {"optimize", hours(OPTIMIZE_INTERVAL_HOURS), {},
+         [this] { return this->dataManager->optimize(); }},
+    };
+}
+
+MaintenanceScheduler::~MaintenanceScheduler() {
+    stop();
+}
+
+void MaintenanceScheduler::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (worker.joinable()) return;
+
+    auto now = std::chrono::steady_clock::now();
+    for (Task& task : tasks) {
+        task.due = now + task.interval;
+    }
+    stopping = false;
+    // Called by committing threads, so it must not wait on `mutex`; a
+    // wake-up lost in the gap is caught by the WAL task's own interval
+    dataManager->setBackgroundCheckpoints([this] {
+        if (!walCheckpointDue.exchange(true)) {
+            wakeUp.notify_one();
+        }
+    });
+    worker = std::thread(&MaintenanceScheduler::run, this);
+}
+
+void MaintenanceScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!worker.joinable()) return;
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    worker.join();
+
+    // A running automatic backup is left to the DatabaseManager, which
+    // cancels it on shutdown
+    autoBackup.reset();
+    dataManager->setBackgroundCheckpoints(nullptr);
+}
+
+void MaintenanceScheduler::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        auto next = std::min_element(tasks.begin(), tasks.end(),
+                                     [](const Task& a, const Task& b) { return a.due < b.due; });
+        wakeUp.wait_until(lock, next->due, [this] { return stopping || walCheckpointDue.load(); });
+        if (stopping) break;
+
+        // Tasks run unlocked so stop() only waits for the one in progress
+        auto now = std::chrono::steady_clock::now();
+        if (walCheckpointDue.exchange(false)) {
+            tasks.front().due = now;   // the WAL checkpoint task
+        }
+        for (Task& task : tasks) {
+            if (task.due > now) continue;
+            // Rescheduled from now, so a slow run never queues up repeats
+            task.due = now + task.interval;
+
+            lock.unlock();
+            bool success = false;
+            try {
+                success = task.run();
+            } catch (const std::exception& e) {
+                std::cerr << "Maintenance task '" << task.name << "' threw: " << e.what() << std::endl;
+            }
+            if (!success) {
+                std::cerr << "Maintenance task '" << task.name << "' failed; retrying later" << std::endl;
+            }
+            lock.lock();
+            if (stopping) break;
+        }
+    }
+}
+
+bool MaintenanceScheduler::runAutoBackup() {
+    if (autoBackup) {
+        if (!autoBackup->isFinished()) {
+            return true;
+        }
+        BackupJob::State state = autoBackup->getState();
+        autoBackup.reset();
+        if (state == BackupJob::State::COMPLETED) {
+            dataManager->cleanupOldBackups();
+        }
+        // A cancelled run (shutdown, restore) is not a failure; the next
+        // turn starts a new one if it is still due
+        return state != BackupJob::State::FAILED;
+    }
+
+    // The catalog survives restarts, so the interval counts from the last
+    // automatic backup rather than from process start
+    auto lastBackup = std::chrono::system_clock::time_point();
+    for (const auto& backup : dataManager->getBackupHistory()) {
+        if (backup.type == BackupType::AUTO) {
+            lastBackup = std::max(lastBackup, backup.timestamp);
+        }
+    }
+    if (std::chrono::system_clock::now() - lastBackup <
+        std::chrono::hours(DatabaseManager::AUTO_BACKUP_INTERVAL_HOURS)) {
+        return true;
+    }
+
+    // nullptr while another backup is running; checked again next turn
+    autoBackup = dataManager->startBackup("Automatic backup", BackupType::AUTO);
+    return true;
+}
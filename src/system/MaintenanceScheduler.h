@@ -0,0 +1,66 @@
+#ifndef MAINTENANCE_SCHEDULER_H
+#define MAINTENANCE_SCHEDULER_H
+
+#include "../storage/DatabaseManager.h"
+#include <memory>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+
+// One background thread for routine upkeep, so none of it runs on a
+// request path: WAL archiving and checkpoints within the WAL size budget,
+// base snapshots, OTP expiry, automatic backups followed by retention
+// cleanup, archiving of old transactions (once an admin enables it with
+// DatabaseManager::setArchiveHotDays), and PRAGMA optimize. Each task
+// has its own interval; a failing task is logged and retried at its next
+// turn.
+class MaintenanceScheduler {
+public:
+    static const int WAL_CHECK_INTERVAL_SECONDS = 1;
+    static const int OTP_CLEANUP_INTERVAL_SECONDS = 60;
+    static const int BACKUP_CHECK_INTERVAL_MINUTES = 5;
+    static const int BASE_SNAPSHOT_INTERVAL_MINUTES = 15;
+    static const int OPTIMIZE_INTERVAL_HOURS = 6;
+    static const int TRANSACTION_ARCHIVE_INTERVAL_HOURS = 24;
+
+private:
+    struct Task {
+        const char* name;
+        std::chrono::steady_clock::duration interval;
+        std::chrono::steady_clock::time_point due;
+        std::function<bool()> run;
+    };
+
+    std::shared_ptr<DatabaseManager> dataManager;
+    std::vector<Task> tasks;
+    std::shared_ptr<BackupJob> autoBackup;   // only touched by the worker
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool stopping;
+    std::atomic<bool> walCheckpointDue;   // set by commits, runs the WAL task early
+    std::thread worker;
+
+    void run();
+    // Starts an automatic backup once the interval since the last one has
+    // passed, and cleans up old backups after it completes
+    bool runAutoBackup();
+
+public:
+    explicit MaintenanceScheduler(std::shared_ptr<DatabaseManager> dataManager);
+    ~MaintenanceScheduler();
+
+    MaintenanceScheduler(const MaintenanceScheduler&) = delete;
+    MaintenanceScheduler& operator=(const MaintenanceScheduler&) = delete;
+
+    // Takes over WAL checkpoints from the commit path and starts the thread
+    void start();
+    // Finishes the task in progress, then joins the thread
+    void stop();
+};
+
+#endif
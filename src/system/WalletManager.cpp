@@ -8,7 +8,7 @@
 
 const double WalletManager::INITIAL_USER_POINTS = 100.0; // 100 điểm ban đầu
 
-WalletManager::WalletManager(std::shared_ptr<DatabaseManager> dataManager, 
+WalletManager::WalletManager(std::shared_ptr<StorageBackend> dataManager, 
                             std::shared_ptr<OTPManager> otpManager)
     : dataManager(dataManager), otpManager(otpManager) {
 }
@@ -17,14 +17,11 @@ bool WalletManager::initialize() {
     try {
         masterWallet = std::unique_ptr<MasterWallet>(new MasterWallet(10000000.0)); // 10 million initial points
 
-        auto wallets = dataManager->loadAllWallets();
-        
-        for (auto& wallet : wallets) {
-            if (wallet) {
-                std::string walletId = wallet->getId();
-                walletCache[walletId] = wallet;
-            }
-        }
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        dataManager->forEachWallet([this](const Wallet& wallet) {
+            walletCache[wallet.getId()] = std::make_shared<Wallet>(wallet);
+            return true;
+        });
 
         return true;
     }
@@ -43,7 +40,10 @@ bool WalletManager::createUserWallet(const std::string& userId, const std::strin
         auto wallet = std::shared_ptr<Wallet>(new Wallet(walletId, userId, INITIAL_USER_POINTS));
 
         if (dataManager->saveWallet(wallet)) {
-            walletCache[walletId] = wallet;
+            {
+                std::lock_guard<std::mutex> lock(cacheMutex);
+                walletCache[walletId] = wallet;
+            }
 
             std::string masterWalletId = dataManager->getMasterWalletId();
             if (!masterWalletId.empty()) {
@@ -73,9 +73,12 @@ bool WalletManager::createUserWallet(const std::string& userId, const std::strin
 }
 
 std::shared_ptr<Wallet> WalletManager::getWallet(const std::string& walletId) {
-    auto it = walletCache.find(walletId);
-    if (it != walletCache.end()) {
-        return it->second;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = walletCache.find(walletId);
+        if (it != walletCache.end()) {
+            return it->second;
+        }
     }
 
     return loadWalletToCache(walletId);
@@ -83,15 +86,20 @@ std::shared_ptr<Wallet> WalletManager::getWallet(const std::string& walletId) {
 
 std::shared_ptr<Wallet> WalletManager::getWalletByUserId(const std::string& userId) {
     try {
-        for (const auto& pair : walletCache) {
-            if (pair.second->getOwnerId() == userId) {
-                return pair.second;
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            for (const auto& pair : walletCache) {
+                if (pair.second->getOwnerId() == userId) {
+                    return pair.second;
+                }
             }
         }
 
         auto wallet = dataManager->loadWalletByOwnerId(userId);
         if (wallet) {
-            walletCache[wallet->getId()] = wallet;
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            auto inserted = walletCache.emplace(wallet->getId(), wallet);
+            return inserted.first->second;
         }
         return wallet;
     }
@@ -157,6 +165,106 @@ TransferResult WalletManager::transferPoints(const TransferRequest& request) {
     return result;
 }
 
+std::vector<TransferResult> WalletManager::transferPointsBatch(const std::vector<TransferRequest>& requests) {
+    std::vector<TransferResult> results(requests.size(), TransferResult{false, "", "", 0.0});
+    std::vector<TransferRequest> accepted;
+    std::vector<size_t> acceptedIndex;
+    accepted.reserve(requests.size());
+    acceptedIndex.reserve(requests.size());
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const auto& request = requests[i];
+
+        std::string validationError = validateTransferRequest(request, false);
+        if (!validationError.empty()) {
+            results[i].message = validationError;
+            continue;
+        }
+
+        auto fromWallet = getWallet(request.fromWalletId);
+        auto toWallet = getWallet(request.toWalletId);
+        if (!fromWallet || !toWallet) {
+            results[i].message = "Wallet not found.!";
+            continue;
+        }
+        if (fromWallet->getIsLocked() || toWallet->getIsLocked()) {
+            results[i].message = "The wallet has been locked!";
+            continue;
+        }
+
+        accepted.push_back(request);
+        acceptedIndex.push_back(i);
+    }
+
+    try {
+        // Balances are checked by the database in request order, so a wallet
+        // may spend points it received earlier in the same batch
+        auto committed = dataManager->transferPointsBatch(accepted);
+
+        for (size_t k = 0; k < committed.size(); ++k) {
+            const auto& request = accepted[k];
+            TransferResult& result = results[acceptedIndex[k]];
+            result = committed[k];
+
+            if (result.success) {
+                applyCommittedTransfer(getWallet(request.fromWalletId), getWallet(request.toWalletId),
+                                       request.amount, request.description, result.transactionId);
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        for (size_t index : acceptedIndex) {
+            results[index].success = false;
+            results[index].message = "System error: " + std::string(e.what());
+        }
+    }
+
+    return results;
+}
+
+std::future<TransferResult> WalletManager::transferPointsAsync(const TransferRequest& request) {
+    std::promise<TransferResult> rejected;
+    TransferResult result{false, "", "", 0.0};
+
+    std::string validationError = validateTransferRequest(request);
+    if (!validationError.empty()) {
+        result.message = validationError;
+        rejected.set_value(result);
+        return rejected.get_future();
+    }
+
+    try {
+        auto fromWallet = getWallet(request.fromWalletId);
+        auto toWallet = getWallet(request.toWalletId);
+
+        if (!fromWallet || !toWallet) {
+            result.message = "Wallet not found.!";
+        } else if (fromWallet->getIsLocked() || toWallet->getIsLocked()) {
+            result.message = "The wallet has been locked!";
+        } else if (fromWallet->getBalance() < request.amount) {
+            result.message = "Insufficient balance!";
+        } else if (!otpManager->verifyOTP(fromWallet->getOwnerId(), request.otpCode, OTPType::TRANSFER)) {
+            result.message = "The OTP code is incorrect or has expired!";
+        } else {
+            // The database re-checks the balance when the group commits, so
+            // concurrent transfers from one wallet cannot overdraw it
+            return dataManager->submitTransfer(request,
+                [this, fromWallet, toWallet, request](const TransferResult& committed) {
+                    if (committed.success) {
+                        applyCommittedTransfer(fromWallet, toWallet, request.amount,
+                                               request.description, committed.transactionId);
+                    }
+                });
+        }
+    }
+    catch (const std::exception& e) {
+        result.message = "System error: " + std::string(e.what());
+    }
+
+    rejected.set_value(result);
+    return rejected.get_future();
+}
+
 std::string WalletManager::generateTransferOTP(const std::string& fromUserId,
                                               const std::string& toWalletId,
                                               double amount) {
@@ -179,23 +287,37 @@ std::vector<Transaction> WalletManager::getTransactionHistory(const std::string&
                                                              int limit) {
     std::vector<Transaction> transactions;
     
-    auto wallet = getWallet(walletId);
-    if (!wallet) {
+    if (!walletExists(walletId)) {
         return transactions;
     }
 
-    auto allTransactions = wallet->getTransactionHistory();
+    if (limit > 0) {
+        return getTransactionHistoryPage(walletId, HistoryCursor(),
+                                         static_cast<size_t>(limit)).transactions;
+    }
+
+    HistoryCursor cursor;
+    TransactionPage page;
+    do {
+        page = getTransactionHistoryPage(walletId, cursor, MAX_HISTORY_PAGE_SIZE);
+        transactions.insert(transactions.end(), page.transactions.begin(), page.transactions.end());
+        cursor = page.nextCursor;
+    } while (page.hasMore);
 
-    std::sort(allTransactions.begin(), allTransactions.end(),
-              [](const Transaction& a, const Transaction& b) {
-                  return a.getTimestamp() > b.getTimestamp();
-              });
+    return transactions;
+}
 
-    if (limit > 0 && allTransactions.size() > static_cast<size_t>(limit)) {
-        allTransactions.resize(limit);
+TransactionPage WalletManager::getTransactionHistoryPage(const std::string& walletId,
+                                                         const HistoryCursor& cursor,
+                                                         size_t pageSize) {
+    if (pageSize > MAX_HISTORY_PAGE_SIZE) {
+        pageSize = MAX_HISTORY_PAGE_SIZE;
     }
+    return dataManager->loadTransactionPage(walletId, cursor, pageSize);
+}
 
-    return allTransactions;
+WalletFlowSummary WalletManager::getWalletFlowSummary(const std::string& walletId) {
+    return dataManager->loadWalletFlowSummary(walletId);
 }
 
 std::vector<Transaction> WalletManager::getTransactionHistoryByDate(
@@ -204,14 +326,28 @@ std::vector<Transaction> WalletManager::getTransactionHistoryByDate(
     const std::chrono::system_clock::time_point& toDate) {
     
     std::vector<Transaction> filteredTransactions;
-    auto allTransactions = getTransactionHistory(walletId);
-
-    for (const auto& transaction : allTransactions) {
-        auto transactionTime = transaction.getTimestamp();
-        if (transactionTime >= fromDate && transactionTime <= toDate) {
-            filteredTransactions.push_back(transaction);
+    if (!walletExists(walletId)) {
+        return filteredTransactions;
+    }
+
+    // Seek straight to toDate and page backwards until fromDate is passed
+    HistoryCursor cursor;
+    cursor.timestamp = std::chrono::duration_cast<std::chrono::seconds>(
+        toDate.time_since_epoch()).count() + 1;
+    TransactionPage page;
+    do {
+        page = getTransactionHistoryPage(walletId, cursor, MAX_HISTORY_PAGE_SIZE);
+        for (const auto& transaction : page.transactions) {
+            auto transactionTime = transaction.getTimestamp();
+            if (transactionTime < fromDate) {
+                return filteredTransactions;
+            }
+            if (transactionTime <= toDate) {
+                filteredTransactions.push_back(transaction);
+            }
         }
-    }
+        cursor = page.nextCursor;
+    } while (page.hasMore);
 
     return filteredTransactions;
 }
@@ -221,9 +357,12 @@ std::vector<std::string> WalletManager::findWalletsByOwner(const std::string& ow
     
     try {
         // Tìm trong cache
-        for (const auto& pair : walletCache) {
-            if (pair.second->getOwnerId() == ownerId) {
-                walletIds.push_back(pair.first);
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            for (const auto& pair : walletCache) {
+                if (pair.second->getOwnerId() == ownerId) {
+                    walletIds.push_back(pair.first);
+                }
             }
         }
 
@@ -332,25 +471,18 @@ std::string WalletManager::getSystemStatistics() {
     try {
         std::ostringstream stats;
 
-        int totalWallets = walletCache.size();
-        double totalPoints = 0.0;
-        int activeWallets = 0;
-        int lockedWallets = 0;
+        // Counters come from the database, so wallets that were never
+        // loaded into the cache are included
+        SystemStats systemStats;
+        if (!dataManager->loadSystemStats(systemStats)) {
+            return "Loi lay thong ke: khong doc duoc du lieu he thong";
+        }
 
-        for (const auto& pair : walletCache) {
-            auto wallet = pair.second;
-            totalPoints += wallet->getBalance();
-            
-            if (wallet->getIsLocked()) {
-                lockedWallets++;
-            } else {
-                activeWallets++;
-            }
-        }        stats << "===== THONG KE HE THONG VI =====\n";
-        stats << "Tong so vi: " << totalWallets << "\n";
-        stats << "Vi dang hoat dong: " << activeWallets << "\n";
-        stats << "Vi bi khoa: " << lockedWallets << "\n";
-        stats << "Tong diem trong he thong: " << std::fixed << std::setprecision(2) << totalPoints << "\n";
+        stats << "===== THONG KE HE THONG VI =====\n";
+        stats << "Tong so vi: " << systemStats.wallets << "\n";
+        stats << "Vi dang hoat dong: " << systemStats.wallets - systemStats.lockedWallets << "\n";
+        stats << "Vi bi khoa: " << systemStats.lockedWallets << "\n";
+        stats << "Tong diem trong he thong: " << std::fixed << std::setprecision(2) << systemStats.totalPoints << "\n";
         stats << "Diem con lai trong vi tong: " << masterWallet->getTotalPoints() << "\n";
         
         return stats.str();
@@ -378,6 +510,7 @@ bool WalletManager::cancelPendingTransaction(const std::string& transactionId,
 
 bool WalletManager::saveAllWallets() {
     try {
+        std::lock_guard<std::mutex> lock(cacheMutex);
         for (const auto& pair : walletCache) {
             if (!dataManager->saveWallet(pair.second)) {
                 return false;
@@ -392,6 +525,7 @@ bool WalletManager::saveAllWallets() {
 }
 
 void WalletManager::clearWalletCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
     walletCache.clear();
 }
 
@@ -401,7 +535,10 @@ std::shared_ptr<Wallet> WalletManager::loadWalletToCache(const std::string& wall
     try {
         auto wallet = dataManager->loadWallet(walletId);
         if (wallet) {
-            walletCache[walletId] = wallet;
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            // Another thread may have cached it while we were loading
+            auto inserted = walletCache.emplace(walletId, wallet);
+            return inserted.first->second;
         }
         return wallet;
     }
@@ -412,10 +549,11 @@ std::shared_ptr<Wallet> WalletManager::loadWalletToCache(const std::string& wall
 }
 
 void WalletManager::removeWalletFromCache(const std::string& walletId) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
     walletCache.erase(walletId);
 }
 
-std::string WalletManager::validateTransferRequest(const TransferRequest& request) {
+std::string WalletManager::validateTransferRequest(const TransferRequest& request, bool requireOtp) {
     if (request.amount <= 0) {
         return "So diem phai lon hon 0!";
     }
@@ -428,7 +566,7 @@ std::string WalletManager::validateTransferRequest(const TransferRequest& reques
         return "Khong the chuyen diem cho chinh minh!";
     }
 
-    if (request.otpCode.empty()) {
+    if (requireOtp && request.otpCode.empty()) {
         return "Can ma OTP de xac thuc giao dich!";
     }
 
@@ -452,34 +590,7 @@ std::string WalletManager::executeAtomicTransfer(std::shared_ptr<Wallet> fromWal
         );
         
         if (!transactionId.empty()) {
-            fromWallet->withdraw(amount);
-            toWallet->deposit(amount);
-
-            Transaction fromTransaction(
-                transactionId,
-                fromWallet->getId(),
-                toWallet->getId(),
-                amount,
-                TransactionType::TRANSFER_OUT,
-                TransactionStatus::COMPLETED,
-                description
-            );
-            
-            Transaction toTransaction(
-                transactionId,
-                fromWallet->getId(),
-                toWallet->getId(),
-                amount,
-                TransactionType::TRANSFER_IN,
-                TransactionStatus::COMPLETED,
-                description
-            );
-
-            fromWallet->addTransaction(fromTransaction);
-            toWallet->addTransaction(toTransaction);
-
-            logTransaction(fromTransaction, "COMPLETED", "Transfer executed successfully");
-            
+            applyCommittedTransfer(fromWallet, toWallet, amount, description, transactionId);
             return transactionId;
         } else {
             return "";
@@ -491,6 +602,45 @@ std::string WalletManager::executeAtomicTransfer(std::shared_ptr<Wallet> fromWal
     }
 }
 
+void WalletManager::applyCommittedTransfer(std::shared_ptr<Wallet> fromWallet,
+                                           std::shared_ptr<Wallet> toWallet,
+                                           double amount,
+                                           const std::string& description,
+                                           const std::string& transactionId) {
+    if (!fromWallet || !toWallet) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    fromWallet->withdraw(amount);
+    toWallet->deposit(amount);
+
+    Transaction fromTransaction(
+        transactionId,
+        fromWallet->getId(),
+        toWallet->getId(),
+        amount,
+        TransactionType::TRANSFER_OUT,
+        TransactionStatus::COMPLETED,
+        description
+    );
+    
+    Transaction toTransaction(
+        transactionId,
+        fromWallet->getId(),
+        toWallet->getId(),
+        amount,
+        TransactionType::TRANSFER_IN,
+        TransactionStatus::COMPLETED,
+        description
+    );
+
+    fromWallet->addTransaction(fromTransaction);
+    toWallet->addTransaction(toTransaction);
+
+    logTransaction(fromTransaction, "COMPLETED", "Transfer executed successfully");
+}
+
 void WalletManager::rollbackTransfer(std::shared_ptr<Wallet> fromWallet,
                                    std::shared_ptr<Wallet> toWallet,
                                    double amount,
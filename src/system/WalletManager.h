@@ -4,39 +4,34 @@
 #include "../models/Wallet.h"
 #include "../security/SecurityUtils.h"
 #include "../security/OTPManager.h"
-#include "../storage/DatabaseManager.h"
+#include "../storage/StorageBackend.h"
 #include <memory>
 #include <unordered_map>
 #include <vector>
-#include "../thread_compat.h"
-
-struct TransferRequest {
-    std::string fromWalletId;
-    std::string toWalletId;
-    double amount;
-    std::string description;
-    std::string otpCode;
-};
+#include <future>
+#ifdef _WIN32
+    #include "../thread_compat.h"
+#else
+    #include <mutex>
+#endif
 
-struct TransferResult {
-    bool success;
-    std::string message;
-    std::string transactionId;
-    double newBalance;
-};
 class WalletManager {
 private:
-    std::shared_ptr<DatabaseManager> dataManager;
+    std::shared_ptr<StorageBackend> dataManager;
     std::shared_ptr<OTPManager> otpManager;
     std::unique_ptr<MasterWallet> masterWallet;
     
     std::unordered_map<std::string, std::shared_ptr<Wallet>> walletCache;
-    // std::mutex transferMutex;
+    // Guards walletCache and cached balances against group-commit callbacks
+    std::mutex cacheMutex;
     
-    static const double INITIAL_USER_POINTS;
+    static const size_t MAX_HISTORY_PAGE_SIZE = 1000;
 
 public:
-    WalletManager(std::shared_ptr<DatabaseManager> dataManager, 
+    // Balance every new account's wallet starts with
+    static const double INITIAL_USER_POINTS;
+
+    WalletManager(std::shared_ptr<StorageBackend> dataManager, 
                   std::shared_ptr<OTPManager> otpManager);
 
     bool initialize();
@@ -44,12 +39,24 @@ public:
     std::shared_ptr<Wallet> getWallet(const std::string& walletId);
     std::shared_ptr<Wallet> getWalletByUserId(const std::string& userId);
     TransferResult transferPoints(const TransferRequest& request);
+    // System-initiated bulk transfers (e.g. reward runs): not OTP-gated,
+    // committed together, with one result per request in input order
+    std::vector<TransferResult> transferPointsBatch(const std::vector<TransferRequest>& requests);
+    // Validates and verifies the OTP immediately, then hands the transfer to
+    // the group-commit writer; the future completes when its group commits
+    std::future<TransferResult> transferPointsAsync(const TransferRequest& request);
     std::string generateTransferOTP(const std::string& fromUserId,
                                    const std::string& toWalletId,
                                    double amount);
     double getBalance(const std::string& walletId);
     std::vector<Transaction> getTransactionHistory(const std::string& walletId, 
                                                   int limit = -1);
+    // One page of history read from the database, newest first; pass the
+    // returned nextCursor back in to continue
+    TransactionPage getTransactionHistoryPage(const std::string& walletId,
+                                              const HistoryCursor& cursor = HistoryCursor(),
+                                              size_t pageSize = StorageBackend::DEFAULT_HISTORY_PAGE_SIZE);
+    WalletFlowSummary getWalletFlowSummary(const std::string& walletId);
     std::vector<Transaction> getTransactionHistoryByDate(
         const std::string& walletId,
         const std::chrono::system_clock::time_point& fromDate,
@@ -73,11 +80,16 @@ public:
 private:
     std::shared_ptr<Wallet> loadWalletToCache(const std::string& walletId);
     void removeWalletFromCache(const std::string& walletId);
-    std::string validateTransferRequest(const TransferRequest& request);
+    std::string validateTransferRequest(const TransferRequest& request, bool requireOtp = true);
     std::string executeAtomicTransfer(std::shared_ptr<Wallet> fromWallet,
                                      std::shared_ptr<Wallet> toWallet,
                                      double amount,
                                      const std::string& description);
+    void applyCommittedTransfer(std::shared_ptr<Wallet> fromWallet,
+                                std::shared_ptr<Wallet> toWallet,
+                                double amount,
+                                const std::string& description,
+                                const std::string& transactionId);
     void rollbackTransfer(std::shared_ptr<Wallet> fromWallet,
                          std::shared_ptr<Wallet> toWallet,
                          double amount,
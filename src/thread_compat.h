@@ -1,6 +1,12 @@
 #ifndef THREAD_COMPAT_H
 #define THREAD_COMPAT_H
 
+#include <cstddef> // pulls in the libstdc++ config that defines _GLIBCXX_HAS_GTHREADS
+
+#if defined(_GLIBCXX_HAS_GTHREADS) || !defined(__GLIBCXX__)
+// Toolchain provides real threads (e.g. MinGW-w64 posix): use them
+#include <mutex>
+#else
 // For MinGW compatibility - use simple no-op mutex for single-threaded operation
 namespace std {
     class mutex {
@@ -9,6 +15,7 @@ namespace std {
         ~mutex() = default;
         void lock() { /* no-op for single-threaded compatibility */ }
         void unlock() { /* no-op for single-threaded compatibility */ }
+        bool try_lock() { return true; }
         
         // Non-copyable
         mutex(const mutex&) = delete;
@@ -33,5 +40,6 @@ namespace std {
         lock_guard& operator=(const lock_guard&) = delete;
     };
 }
+#endif
 
 #endif // THREAD_COMPAT_H
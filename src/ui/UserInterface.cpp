@@ -17,6 +17,7 @@
 #include <cctype>
 #include "UserValidator.h"
 #include <variant>
+#include <fstream>
 
 #ifdef _WIN32
 // Windows version uses conio.h getch() directly - no need to redefine
@@ -37,10 +38,10 @@ int getch() {
 
 UserInterface::UserInterface(AuthSystem& authSys)
     : authSystem(authSys), isRunning(false) {
-    // Initialize WalletManager using the DatabaseManager from AuthSystem
-    auto dataManager = authSystem.getDataManager();
+    // Initialize WalletManager on the same storage backend as AuthSystem
+    auto storage = authSystem.getStorage();
     auto otpManager = std::make_shared<OTPManager>();
-    walletManager = std::unique_ptr<WalletManager>(new WalletManager(dataManager, otpManager));
+    walletManager = std::unique_ptr<WalletManager>(new WalletManager(storage, otpManager));
 }
 
 UserInterface::~UserInterface() {
@@ -682,20 +683,12 @@ void UserInterface::viewWalletReport() {
         return;
     }
 
-    auto transactions = walletManager->getTransactionHistory(wallet->getId());
+    auto flow = walletManager->getWalletFlowSummary(wallet->getId());
     
-    double totalIn = 0.0, totalOut = 0.0;
-    int countIn = 0, countOut = 0;
+    double totalIn = flow.totalIn, totalOut = flow.totalOut;
+    int countIn = flow.countIn, countOut = flow.countOut;
     
-    for (const auto& transaction : transactions) {
-        if (transaction.getToWalletId() == wallet->getId()) {
-            totalIn += transaction.getAmount();
-            countIn++;
-        } else {
-            totalOut += transaction.getAmount();
-            countOut++;
-        }
-    }    std::cout << "+--------------------------------------------------+\n";
+    std::cout << "+--------------------------------------------------+\n";
     std::cout << "|                 WALLET REPORT                   |\n";
     std::cout << "|--------------------------------------------------|\n";
     std::cout << "| Current balance: " << std::setw(30) << formatCurrency(wallet->getBalance()) << " |\n";
@@ -846,6 +839,7 @@ void UserInterface::manageUserAccount() {
         std::cout << " 3. Edit User Information\n";
         std::cout << " 4. Reset User Password\n";
         std::cout << " 5. View User Wallet Details\n";
+        std::cout << " 6. Import Accounts from File\n";
         std::cout << " 0. Return to Main Menu\n\n";
         
         int choice = getIntInput("Choose function: ", 0, 6);
@@ -856,11 +850,75 @@ void UserInterface::manageUserAccount() {
             case 3: editUserInformation(); break;
             case 4: resetUserPassword(); break;
             case 5: viewUserWalletDetails(); break;
+            case 6: importAccounts(); break;
             case 0: return;
         }
     }
 }
 
+void UserInterface::importAccounts() {
+    clearScreen();
+    showHeader();
+    
+    std::cout << "+--------------------------------------------------+\n";
+    std::cout << "|            IMPORT ACCOUNTS FROM FILE             |\n";
+    std::cout << "+--------------------------------------------------+\n\n";
+    std::cout << "CSV with a header row, or NDJSON (one object per line).\n";
+    std::cout << "Fields: username, full_name, email, phone_number,\n";
+    std::cout << "optional role (admin/user) and password.\n\n";
+    
+    std::string path = getInput("File path (empty to cancel): ");
+    if (path.empty()) return;
+    
+    showInfo("Importing accounts...");
+    BulkLoadReport report = authSystem.importAccounts(path);
+    if (!report.success) {
+        showError(report.message);
+        pauseScreen();
+        return;
+    }
+    
+    showSuccess(report.message);
+    std::ostringstream timing;
+    timing << std::fixed << std::setprecision(2)
+           << "Time: " << report.totalSeconds << "s (read " << report.parseSeconds
+           << "s, validate and hash " << report.prepareSeconds
+           << "s, insert " << report.insertSeconds << "s)\n"
+           << "Throughput: " << std::setprecision(0) << report.accountsPerSecond() << " accounts/s\n";
+    std::cout << "\nCreated: " << report.accountsCreated << "\n";
+    std::cout << "Rejected: " << report.rejected.size() << "\n";
+    std::cout << timing.str();
+    
+    const size_t shown = 20;
+    for (size_t i = 0; i < report.rejected.size() && i < shown; ++i) {
+        const BulkLoadIssue& issue = report.rejected[i];
+        std::cout << "  Line " << issue.line;
+        if (!issue.username.empty()) std::cout << " (" << issue.username << ")";
+        std::cout << ": " << issue.message << "\n";
+    }
+    if (report.rejected.size() > shown) {
+        std::cout << "  ... and " << (report.rejected.size() - shown) << " more\n";
+    }
+    
+    if (!report.generatedPasswords.empty()) {
+        std::string passwordFile = path + ".passwords.csv";
+        std::ofstream out(passwordFile);
+        out << "username,password\n";
+        for (const auto& entry : report.generatedPasswords) {
+            out << entry.first << "," << entry.second << "\n";
+        }
+        if (out) {
+            std::cout << "\n";
+            showWarning("Generated passwords written to: " + passwordFile);
+            showWarning("- Deliver them to the users, then delete the file");
+            showWarning("- Users MUST change password on first login");
+        } else {
+            showError("Cannot write generated passwords to: " + passwordFile);
+        }
+    }
+    pauseScreen();
+}
+
 void UserInterface::viewSystemStatistics() {
     clearScreen();
     showHeader();
@@ -980,7 +1038,10 @@ void UserInterface::manageBackup() {
             "Create Manual Backup",
             "View Backup History",
             "Restore from Backup",
+            "Restore to Point in Time",
             "Cleanup Old Backups",
+            "Export Transactions",
+            "Transaction Archiving",
             "Return to Main Menu"
         };
         
@@ -990,8 +1051,11 @@ void UserInterface::manageBackup() {
             case 1: createManualBackup(); break;
             case 2: viewBackupHistory(); break;
             case 3: restoreFromBackup(); break;
-            case 4: cleanupBackups(); break;
-            case 5: 
+            case 4: restoreToPointInTime(); break;
+            case 5: cleanupBackups(); break;
+            case 6: exportTransactions(); break;
+            case 7: configureTransactionArchiving(); break;
+            case 8: 
                 showInfo("Returning to main menu...");
                 pauseScreen();
                 break;
@@ -1000,7 +1064,7 @@ void UserInterface::manageBackup() {
                 pauseScreen();
                 break;
         }
-    } while (choice != 5);
+    } while (choice != 8);
 }
 
 void UserInterface::createManualBackup() {
@@ -1134,6 +1198,9 @@ void UserInterface::restoreFromBackup() {
         std::cout << "\nSelected backup details:\n";
         std::cout << "- ID: " << selectedBackup.backupId << "\n";
         std::cout << "- Created: " << formatDateTime(selectedBackup.timestamp) << "\n";
+        if (!selectedBackup.description.empty()) {
+            std::cout << "- Description: " << selectedBackup.description << "\n";
+        }
         std::cout << "- Size: " << formatFileSize(selectedBackup.fileSize) << "\n\n";
         
         showWarning("WARNING: Restoring will overwrite current data!");
@@ -1165,6 +1232,205 @@ void UserInterface::restoreFromBackup() {
     pauseScreen();
 }
 
+void UserInterface::restoreToPointInTime() {
+    clearScreen();
+    showHeader();
+    
+    std::cout << "+--------------------------------------------------+\n";
+    std::cout << "|             RESTORE TO POINT IN TIME             |\n";
+    std::cout << "+--------------------------------------------------+\n\n";
+
+    try {
+        auto dataManager = authSystem.getDataManager();
+        if (!dataManager) {
+            showError("Unable to access data manager!");
+            pauseScreen();
+            return;
+        }
+
+        auto earliest = dataManager->getEarliestRecoveryPoint();
+        if (earliest == std::chrono::system_clock::time_point()) {
+            showInfo("No WAL archive available yet.");
+            pauseScreen();
+            return;
+        }
+
+        std::cout << "Recoverable range: " << formatDateTime(earliest) << " - now\n\n";
+        std::string input = getInput("Restore to (dd/mm/yyyy hh:mm:ss): ");
+
+        std::tm timeInfo = {};
+        std::istringstream iss(input);
+        iss >> std::get_time(&timeInfo, "%d/%m/%Y %H:%M:%S");
+        if (iss.fail()) {
+            showError("Invalid date/time format!");
+            pauseScreen();
+            return;
+        }
+        timeInfo.tm_isdst = -1;
+        auto target = std::chrono::system_clock::from_time_t(std::mktime(&timeInfo));
+        if (target < earliest) {
+            showError("That time is before the oldest archived snapshot!");
+            pauseScreen();
+            return;
+        }
+
+        std::cout << "\nData will be restored to its state at " << formatDateTime(target) << ".\n";
+        showWarning("WARNING: All changes made after this time will be rolled back!");
+        
+        if (!confirmAction("Do you want to proceed with restore?")) {
+            showInfo("Restore cancelled!");
+            pauseScreen();
+            return;
+        }
+
+        showInfo("Creating safety backup of current data...");
+        dataManager->createBackup("Pre-restore backup", BackupType::EMERGENCY);
+        
+        showInfo("Replaying archived changes...");
+        if (dataManager->restoreToPointInTime(target)) {
+            showSuccess("Data restored successfully!");
+            showWarning("Please restart the application to see changes.");
+        } else {
+            showError("Restore failed!");
+        }
+        
+    } catch (const std::exception& e) {
+        showError("Restore operation failed: " + std::string(e.what()));
+    }
+    
+    pauseScreen();
+}
+
+void UserInterface::exportTransactions() {
+    clearScreen();
+    showHeader();
+    
+    std::cout << "+--------------------------------------------------+\n";
+    std::cout << "|               EXPORT TRANSACTIONS                |\n";
+    std::cout << "+--------------------------------------------------+\n\n";
+
+    try {
+        auto dataManager = authSystem.getDataManager();
+        if (!dataManager) {
+            showError("Unable to access data manager!");
+            pauseScreen();
+            return;
+        }
+
+        TransactionExportFilter filter;
+        filter.walletId = getInput("Wallet ID (leave empty for all wallets): ");
+
+        // Both ends are whole days; the end day is included
+        auto readDate = [this](const std::string& prompt, int64_t& seconds) {
+            std::string input = getInput(prompt);
+            if (input.empty()) return true;
+            std::tm timeInfo = {};
+            std::istringstream iss(input);
+            iss >> std::get_time(&timeInfo, "%d/%m/%Y");
+            if (iss.fail()) return false;
+            timeInfo.tm_isdst = -1;
+            seconds = static_cast<int64_t>(std::mktime(&timeInfo));
+            return true;
+        };
+        int64_t toDay = -1;
+        if (!readDate("From date (dd/mm/yyyy, empty for the beginning): ", filter.from) ||
+            !readDate("To date (dd/mm/yyyy, empty for today): ", toDay)) {
+            showError("Invalid date format!");
+            pauseScreen();
+            return;
+        }
+        if (toDay >= 0) {
+            filter.until = toDay + 24 * 60 * 60;
+        }
+        if (filter.from >= filter.until) {
+            showError("The start date is after the end date!");
+            pauseScreen();
+            return;
+        }
+
+        std::vector<std::string> formatOptions = {"CSV", "NDJSON (one JSON object per line)"};
+        int formatChoice = showMenuSelection("Select format:", formatOptions);
+        if (formatChoice != 1 && formatChoice != 2) {
+            showError("Invalid selection!");
+            pauseScreen();
+            return;
+        }
+        ExportFormat format = formatChoice == 1 ? ExportFormat::CSV : ExportFormat::NDJSON;
+
+        std::string path = getInput("Output file: ");
+        if (path.empty()) {
+            showInfo("Export cancelled!");
+            pauseScreen();
+            return;
+        }
+
+        showInfo("Exporting transactions...");
+        auto started = std::chrono::steady_clock::now();
+        int64_t rows = dataManager->exportTransactions(path, format, filter);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        if (rows < 0) {
+            showError("Export failed!");
+        } else {
+            std::ostringstream message;
+            message << "Exported " << rows << " transactions to " << path
+                    << " in " << std::fixed << std::setprecision(2) << seconds << "s";
+            showSuccess(message.str());
+        }
+        
+    } catch (const std::exception& e) {
+        showError("Export failed: " + std::string(e.what()));
+    }
+    
+    pauseScreen();
+}
+
+void UserInterface::configureTransactionArchiving() {
+    clearScreen();
+    showHeader();
+    
+    std::cout << "+--------------------------------------------------+\n";
+    std::cout << "|              TRANSACTION ARCHIVING               |\n";
+    std::cout << "+--------------------------------------------------+\n\n";
+
+    try {
+        auto dataManager = authSystem.getDataManager();
+        if (!dataManager) {
+            showError("Unable to access data manager!");
+            pauseScreen();
+            return;
+        }
+
+        int hotDays = dataManager->getArchiveHotDays();
+        if (hotDays > 0) {
+            std::cout << "Automatic archiving: ON, transactions older than " << hotDays
+                      << " days move to the monthly archives once a day\n\n";
+        } else {
+            std::cout << "Automatic archiving: OFF\n\n";
+        }
+        std::cout << "Archived transactions stay visible in history and exports.\n\n";
+
+        int days = getIntInput("Days of history to keep in the main database (0 = off): ", 0, 3650);
+        if (days > 0 && !confirmAction("Transactions older than " + std::to_string(days) +
+                                       " days will be moved to the archives. Continue?")) {
+            showInfo("Operation cancelled!");
+            pauseScreen();
+            return;
+        }
+
+        if (dataManager->setArchiveHotDays(days)) {
+            showSuccess(days > 0 ? "Automatic archiving enabled!" : "Automatic archiving disabled!");
+        } else {
+            showError("Cannot save archiving setting!");
+        }
+        
+    } catch (const std::exception& e) {
+        showError("Operation failed: " + std::string(e.what()));
+    }
+    
+    pauseScreen();
+}
+
 void UserInterface::cleanupBackups() {
     clearScreen();
     showHeader();
@@ -1199,15 +1465,13 @@ void UserInterface::cleanupBackups() {
 
         std::cout << "\nCurrent backup count: " << backupHistory.size() << "\n";
         std::cout << "Will keep latest: " << keepCount << " backups\n";
+        std::cout << "plus the newest backup of each recent day, week and month\n\n";
         
         if (static_cast<int>(backupHistory.size()) <= keepCount) {
             showInfo("No cleanup needed - backup count is within limit.");
             pauseScreen();
             return;
         }
-        
-        int toDelete = static_cast<int>(backupHistory.size()) - keepCount;
-        std::cout << "Will delete: " << toDelete << " old backups\n\n";
 
         if (!confirmAction("Do you want to proceed with cleanup?")) {
             showInfo("Cleanup cancelled!");
@@ -1217,17 +1481,11 @@ void UserInterface::cleanupBackups() {
 
         showInfo("Cleaning up old backups...");
         
-        int deletedCount = 0;
-        // Note: In a real implementation, DataManager would have a cleanup method
-        // For now, we'll simulate the cleanup
-        for (int i = keepCount; i < static_cast<int>(backupHistory.size()); ++i) {
-            // In real implementation: dataManager->deleteBackup(backupHistory[i].backupId);
-            deletedCount++;
-        }
+        int deletedCount = dataManager->cleanupOldBackups(keepCount);
         
         showSuccess("Cleanup completed!");
         std::cout << "Deleted " << deletedCount << " old backup files.\n";
-        std::cout << "Kept " << keepCount << " most recent backups.\n";
+        std::cout << "Kept " << dataManager->getBackupHistory().size() << " backups.\n";
         
     } catch (const std::exception& e) {
         showError("Cleanup operation failed: " + std::string(e.what()));
@@ -1782,7 +2040,7 @@ void UserInterface::viewUserWalletDetails() {
     std::cout << " Created      : " << formatDateTime(wallet->getCreatedAt()) << "\n";
     
     // Show recent transactions
-    auto transactions = wallet->getTransactionHistory();
+    auto transactions = walletManager->getTransactionHistory(wallet->getId(), 5);
     if (!transactions.empty()) {
         std::cout << "\n Recent Transactions (last 5):\n";
         std::cout << " +----------+--------------+----------+---------------------+\n";        
@@ -1790,7 +2048,7 @@ void UserInterface::viewUserWalletDetails() {
         std::cout << " +----------+--------------+----------+---------------------+\n";
         
         int count = 0;
-        for (auto it = transactions.rbegin(); it != transactions.rend() && count < 5; ++it, ++count) {
+        for (auto it = transactions.begin(); it != transactions.end() && count < 5; ++it, ++count) {
             const auto& tx = *it;
             std::string typeStr = (tx.getType() == TransactionType::TRANSFER) ? "Transfer" : "Other";            std::cout << " | " << std::setw(8) << formatDate(tx.getTimestamp()) 
                       << " | " << std::setw(12) << typeStr
@@ -48,13 +48,17 @@ private:
     void viewUserWalletDetails();
     void createNewAccount();
     void manageUserAccount();
+    void importAccounts();
     void viewSystemStatistics();
     void issuePointsFromMaster();
     void manageBackup();
     void createManualBackup();
     void viewBackupHistory();
     void restoreFromBackup();
+    void restoreToPointInTime();
     void cleanupBackups();
+    void exportTransactions();
+    void configureTransactionArchiving();
     
     std::string getInput(const std::string& prompt);
     std::string getPassword(const std::string& prompt);
@@ -1,5 +1,6 @@
 // UserValidator.cpp
 // Tách các hàm kiểm tra hợp lệ user ra file riêng
+// Regex được biên dịch một lần (static const) và dùng chung an toàn giữa các luồng
 #include "UserValidator.h"
 #include <regex>
 #include <algorithm>
@@ -8,7 +9,7 @@
 
 bool UserValidator::isValidUsername(const std::string& username) {
     if (username.empty() || username.length() > 20) return false;
-    std::regex usernameRegex(R"(^[a-zA-Z0-9_]{3,20}$)");
+    static const std::regex usernameRegex(R"(^[a-zA-Z0-9_]{3,20}$)");
     if (!std::regex_match(username, usernameRegex)) return false;
     if (username.find("..") != std::string::npos) return false;
     if (username[0] == '.' || username[username.length()-1] == '.') return false;
@@ -17,7 +18,7 @@ bool UserValidator::isValidUsername(const std::string& username) {
 
 bool UserValidator::isValidFullName(const std::string& fullName) {
     if (fullName.empty() || fullName.length() > 30) return false;
-    std::regex fullNameRegex(R"(^[a-zA-Z\s]{0,30}$)");
+    static const std::regex fullNameRegex(R"(^[a-zA-Z\s]{0,30}$)");
     if (!std::regex_match(fullName, fullNameRegex)) return false;
     if (fullName.find("..") != std::string::npos) return false;
     if (fullName[0] == '.' || fullName[fullName.length()-1] == '.') return false;
@@ -26,7 +27,7 @@ bool UserValidator::isValidFullName(const std::string& fullName) {
 
 bool UserValidator::isValidEmail(const std::string& email) {
     if (email.empty() || email.length() > 254) return false;
-    std::regex emailRegex(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})");
+    static const std::regex emailRegex(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})");
     if (!std::regex_match(email, emailRegex)) return false;
     if (email.find("..") != std::string::npos) return false;
     if (email[0] == '.' || email[email.length()-1] == '.') return false;
@@ -41,7 +42,7 @@ bool UserValidator::isValidPhoneNumber(const std::string& phone) {
         [](char c) { return c == ' ' || c == '-' || c == '(' || c == ')' || c == '+'; }), 
         cleanPhone.end());
     if (!std::all_of(cleanPhone.begin(), cleanPhone.end(), ::isdigit)) return false;
-    std::vector<std::regex> phonePatterns = {
+    static const std::vector<std::regex> phonePatterns = {
         std::regex(R"(^84[0-9]{9,10}$)"),
         std::regex(R"(^0[0-9]{9,10}$)"),
         std::regex(R"(^[0-9]{10,11}$)")
@@ -56,10 +57,10 @@ bool UserValidator::isValidPhoneNumber(const std::string& phone) {
 std::string UserValidator::validateStrongPassword(const std::string& password) {
     if (password.length() < 8) return "Password must be at least 8 characters long.";
 
-    std::regex lowercase("[a-z]");
-    std::regex uppercase("[A-Z]");
-    std::regex digit("[0-9]");
-    std::regex special("[^a-zA-Z0-9]");
+    static const std::regex lowercase("[a-z]");
+    static const std::regex uppercase("[A-Z]");
+    static const std::regex digit("[0-9]");
+    static const std::regex special("[^a-zA-Z0-9]");
 
     if (!std::regex_search(password, lowercase)) return "Password must contain at least one lowercase letter.";
 